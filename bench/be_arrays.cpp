@@ -0,0 +1,69 @@
+// buf::readBEArray/writeBEArray against one readBE/writeBE per element, over 4096
+// numbers at an odd offset like they'd be inside a packet. the readFromBuf rows are
+// what packet containers did per element before the bulk versions
+
+#include <cstdio>
+#include <vector>
+
+#include "bench.hpp"
+#include "util/BufferHelper.hpp"
+#include "util/net/Packet.hpp"
+
+template<typename T>
+static void run(const char * name) {
+	constexpr sz_t n = 4096;
+	std::vector<T> nums(n);
+	for (sz_t i = 0; i < n; i++) {
+		nums[i] = static_cast<T>(i * 2654435761u);
+	}
+
+	std::vector<u8> bytes(1 + n * sizeof(T));
+	u8 * b = bytes.data() + 1;
+
+	std::printf("%s x %zu:\n", name, n);
+	report("write, per element", timeUs([&] {
+		for (sz_t i = 0; i < n; i++) {
+			buf::writeBE(b + i * sizeof(T), nums[i]);
+		}
+
+		keep(bytes);
+	}));
+
+	report("write, writeBEArray", timeUs([&] {
+		buf::writeBEArray(b, nums.data(), n);
+		keep(bytes);
+	}));
+
+	report("read, per element", timeUs([&] {
+		for (sz_t i = 0; i < n; i++) {
+			nums[i] = buf::readBE<T>(b + i * sizeof(T));
+		}
+
+		keep(nums);
+	}));
+
+	report("read, readFromBuf per element", timeUs([&] {
+		const u8 * p = b;
+		sz_t remaining = n * sizeof(T);
+		for (sz_t i = 0; i < n; i++) {
+			nums[i] = pktdetail::readFromBuf<T>(p, remaining);
+			remaining -= sizeof(T);
+		}
+
+		keep(nums);
+	}));
+
+	report("read, readBEArray", timeUs([&] {
+		buf::readBEArray(nums.data(), b, n);
+		keep(nums);
+	}));
+}
+
+int main() {
+	run<u16>("u16");
+	run<u32>("u32");
+	run<u64>("u64");
+	run<float>("float");
+	run<double>("double");
+	return 0;
+}
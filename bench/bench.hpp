@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+
+#include "util/explints.hpp"
+
+// so the compiler can't drop work whose result is never used
+template<typename T>
+inline void keep(const T& v) {
+	asm volatile("" : : "r"(&v) : "memory");
+}
+
+// calls fn in doubling batches until roundMs passed, returns the mean us per call of
+// the fastest of a few rounds, the slower ones are mostly other things running
+template<typename Fn>
+double timeUs(Fn&& fn, double roundMs = 60.0, u32 rounds = 5) {
+	using clock = std::chrono::steady_clock;
+
+	fn(); // warm up caches and allocations
+	double best = 0.0;
+	for (u32 r = 0; r < rounds; r++) {
+		u64 calls = 0;
+		u64 batch = 1;
+		double ms = 0.0;
+		auto start = clock::now();
+		do {
+			for (u64 i = 0; i < batch; i++) {
+				fn();
+			}
+
+			calls += batch;
+			batch *= 2;
+			ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+		} while (ms < roundMs);
+
+		double us = ms * 1000.0 / calls;
+		best = r == 0 ? us : std::min(best, us);
+	}
+
+	return best;
+}
+
+inline void report(const char * name, double us) {
+	std::printf("  %-46s %10.3f us\n", name, us);
+}
@@ -0,0 +1,189 @@
+// remote cursor storage: CursorStore against the pid sorted std::vector<Cursor> World kept
+// before it, driven the way World::handleUpdates drives them
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "bench.hpp"
+#include "cursor_env.hpp"
+#include "world/Cursor.hpp"
+#include "world/CursorStore.hpp"
+
+// what World::handleUpdates did with its cursors before CursorStore
+class SortedCursors {
+	std::vector<Cursor> cursors;
+
+public:
+	auto lowerBound(Cursor::Id id) {
+		return std::lower_bound(cursors.begin(), cursors.end(), id, [] (const Cursor& c, Cursor::Id i) {
+			return c.getId() < i;
+		});
+	}
+
+	Cursor * find(Cursor::Id id) {
+		auto it = lowerBound(id);
+		return it != cursors.end() && it->getId() == id ? &*it : nullptr;
+	}
+
+	void show(Cursor::Id id, WorldPos x, WorldPos y, ToolManager& tm) {
+		cursors.emplace(lowerBound(id), fakeUser(), id, x, y, 0, tm, 0, 0);
+	}
+
+	void hide(Cursor::Id id) {
+		cursors.erase(lowerBound(id));
+	}
+
+	sz_t size() const {
+		return cursors.size();
+	}
+};
+
+// the same random pids and positions for every store
+class Crowd {
+	std::mt19937 rng;
+	std::vector<Cursor::Id> live;
+	u32 shown;
+
+public:
+	Crowd()
+	: rng(42),
+	  shown(0) { }
+
+	template<typename Show>
+	void fill(sz_t n, Show show) {
+		while (live.size() < n) {
+			showOne(show);
+		}
+	}
+
+	template<typename Show>
+	void showOne(Show show) {
+		Cursor::Id id = ++shown * 2654435761u; // unique, but not in order
+		live.emplace_back(id);
+		show(id, static_cast<WorldPos>(rng() % 8192), static_cast<WorldPos>(rng() % 8192));
+	}
+
+	template<typename Hide>
+	void hideOne(Hide hide) {
+		sz_t i = rng() % live.size();
+		hide(live[i]);
+		live[i] = live.back();
+		live.pop_back();
+	}
+
+	Cursor::Id pick() {
+		return live[rng() % live.size()];
+	}
+};
+
+template<typename Store>
+static void churn(Store& st, Crowd& crowd, u32 n, ToolManager& tm) {
+	for (u32 i = 0; i < n; i++) {
+		crowd.hideOne([&] (Cursor::Id id) { st.hide(id); });
+		crowd.showOne([&] (Cursor::Id id, WorldPos x, WorldPos y) { st.show(id, x, y, tm); });
+	}
+}
+
+struct StoreAdapter {
+	CursorStore cs;
+
+	void show(Cursor::Id id, WorldPos x, WorldPos y, ToolManager& tm) {
+		cs.insert(fakeUser(), id, x, y, 0, tm, 0, 0);
+	}
+
+	void hide(Cursor::Id id) {
+		cs.remove(cs.find(id));
+	}
+};
+
+int main() {
+	ToolManager& tm = fakeToolManager();
+
+	for (sz_t n : {1000, 10000}) {
+		SortedCursors sorted;
+		StoreAdapter store;
+		Crowd sortedCrowd;
+		Crowd storeCrowd;
+		sortedCrowd.fill(n, [&] (Cursor::Id id, WorldPos x, WorldPos y) { sorted.show(id, x, y, tm); });
+		storeCrowd.fill(n, [&] (Cursor::Id id, WorldPos x, WorldPos y) { store.show(id, x, y, tm); });
+
+		std::printf("%zu cursors, 100 hides and 100 shows:\n", n);
+		report("sorted std::vector<Cursor>", timeUs([&] {
+			churn(sorted, sortedCrowd, 100, tm);
+		}));
+
+		report("CursorStore", timeUs([&] {
+			churn(store, storeCrowd, 100, tm);
+		}));
+
+		std::printf("%zu cursors, 1000 relative updates:\n", n);
+		report("sorted std::vector<Cursor>", timeUs([&] {
+			for (u32 i = 0; i < 1000; i++) {
+				Cursor * c = sorted.find(sortedCrowd.pick());
+				c->updateRel(1, -1, 0, tm, 0, 0);
+			}
+		}));
+
+		report("CursorStore", timeUs([&] {
+			for (u32 i = 0; i < 1000; i++) {
+				CursorStore::Slot s = store.cs.find(storeCrowd.pick());
+				store.cs.updateRel(s, 1, -1, 0, tm, 0, 0);
+			}
+		}));
+
+		keep(sorted.size());
+	}
+
+	for (sz_t n : {1000, 10000}) {
+		// all of them mid animation, with some velocity
+		std::vector<Cursor> old;
+		CursorStore cs;
+		old.reserve(n);
+		fakeNow = 10.0;
+		for (u32 i = 0; i < n; i++) {
+			WorldPos x = i % 4096;
+			WorldPos y = i / 4096;
+			old.emplace_back(fakeUser(), i, x, y, 0, tm, 0, 0);
+			cs.insert(fakeUser(), i, x, y, 0, tm, 0, 0);
+		}
+
+		fakeNow += 0.05;
+		for (u32 i = 0; i < n; i++) {
+			old[i].updateRel(3, 2, 0x37, tm, 0, 0);
+			cs.updateRel(i, 3, 2, 0x37, tm, 0, 0);
+		}
+
+		fakeNow += 0.02;
+		std::vector<float> xs(n);
+		std::vector<float> ys(n);
+
+		std::printf("%zu cursors, drawn positions for one frame:\n", n);
+		report("Cursor::getSmoothX/Y per cursor", timeUs([&] {
+			for (u32 i = 0; i < n; i++) {
+				xs[i] = old[i].getSmoothX();
+				ys[i] = old[i].getSmoothY();
+			}
+
+			keep(xs);
+			keep(ys);
+		}));
+
+		report("CursorStore::getSmoothX/Y per slot", timeUs([&] {
+			for (u32 i = 0; i < n; i++) {
+				xs[i] = cs.getSmoothX(i);
+				ys[i] = cs.getSmoothY(i);
+			}
+
+			keep(xs);
+			keep(ys);
+		}));
+
+		report("CursorStore::interpolate", timeUs([&] {
+			keep(cs.interpolate(fakeNow));
+		}));
+	}
+
+	return 0;
+}
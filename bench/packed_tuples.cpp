@@ -0,0 +1,70 @@
+// vectors of fixed layout tuples: the packed path against decoding and encoding every
+// field through readFromBuf/writeToBuf, which is what they did before it
+
+#include <cstdio>
+#include <tuple>
+#include <vector>
+
+#include "bench.hpp"
+#include "util/net/Packet.hpp"
+
+using Rec = std::tuple<u16, u16, u32>; // like a pixel update: x, y, rgba
+using Pkt = Packet<0, std::vector<Rec>>;
+
+int main() {
+	using namespace pktdetail;
+	constexpr sz_t n = 10000;
+	constexpr sz_t stride = is_tuple_arithmetic<Rec>::size;
+	constexpr auto fieldsOf = std::make_index_sequence<std::tuple_size<Rec>::value>{};
+
+	std::vector<Rec> recs;
+	for (u32 i = 0; i < n; i++) {
+		recs.emplace_back(i % 512, i / 512, i * 2654435761u);
+	}
+
+	std::vector<u8> msg;
+	Pkt::toBuffer(msg, recs);
+	const u8 * data = msg.data() + 1;
+	sz_t size = msg.size() - 1;
+	sz_t prefix = unsignedVarintSize(n);
+
+	std::printf("std::tuple<u16, u16, u32> x %zu:\n", n);
+	report("decode, field by field", timeUs([&] {
+		const u8 * b = data + prefix;
+		sz_t remaining = size - prefix;
+		std::vector<Rec> out;
+		out.reserve(n);
+		for (sz_t i = 0; i < n; i++) {
+			const u8 * prev = b;
+			out.emplace_back(tupleFromBuf<Rec>(b, remaining, fieldsOf));
+			remaining -= b - prev;
+		}
+
+		keep(out);
+	}));
+
+	report("decode, packed (fromBuffer)", timeUs([&] {
+		keep(Pkt::fromBuffer(data, size));
+	}));
+
+	report("decode, packed (tryFromBuffer)", timeUs([&] {
+		keep(Pkt::tryFromBuffer(data, size));
+	}));
+
+	std::vector<u8> out(msg.size());
+	report("encode, field by field", timeUs([&] {
+		u8 * b = out.data();
+		for (const Rec& r : recs) {
+			tupleToBuf(b, r, stride, fieldsOf);
+		}
+
+		keep(out);
+	}));
+
+	report("encode, packed (toBuffer)", timeUs([&] {
+		Pkt::toBuffer(out.data(), out.size(), recs);
+		keep(out);
+	}));
+
+	return 0;
+}
@@ -0,0 +1,88 @@
+// decode cost of the two busiest packets. compares the checked single pass that
+// terminates on bad data, validating and then running that same checked pass, and
+// tryFromBuffer (validation, then an unchecked pass that reserves from its lengths)
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "bench.hpp"
+#include "PacketDefinitions.hpp"
+
+template<typename P>
+static void run(const char * name, const std::vector<u8>& msg) {
+	const u8 * data = msg.data() + 1; // no opcode
+	sz_t size = msg.size() - 1;
+
+	auto expected = P::fromBuffer(data, size);
+	auto got = P::tryFromBuffer(data, size);
+	if (!got || *got != expected) {
+		std::printf("[%s] tryFromBuffer doesn't match fromBuffer\n", name);
+		std::exit(1);
+	}
+
+	std::printf("%s, %zu bytes:\n", name, size);
+	report("fromBuffer (checked, no validation)", timeUs([&] {
+		keep(P::fromBuffer(data, size));
+	}));
+
+	report("validate + fromBuffer", timeUs([&] {
+		if (P::validate(data, size)) {
+			keep(P::fromBuffer(data, size));
+		}
+	}));
+
+	report("tryFromBuffer", timeUs([&] {
+		keep(P::tryFromBuffer(data, size));
+	}));
+}
+
+int main() {
+	u32 seed = 1;
+	auto rnd = [&seed] (u32 mod) {
+		seed = seed * 1664525 + 1013904223;
+		return (seed >> 8) % mod;
+	};
+
+	// a crowded area: a few joins and leaves, lots of small moves
+	net::VPlayersHide hides;
+	net::VPlayersShow shows;
+	net::VPlayersUpdate upds;
+	for (u32 i = 0; i < 20; i++) {
+		hides.emplace_back(10000 + i);
+	}
+
+	for (u32 i = 0; i < 40; i++) {
+		shows.emplace_back(i, net::PlayerUpd<net::DAbsWPos>{20000 + i, rnd(4096), rnd(4096), 1, 0, rnd(1 << 20)});
+	}
+
+	for (u32 i = 0; i < 1000; i++) {
+		upds.emplace_back(i, static_cast<i64>(rnd(64)) - 32, static_cast<i64>(rnd(64)) - 32, 1, rnd(4), rnd(1 << 20));
+	}
+
+	std::vector<u8> msg;
+	CPlayersUpdt::toBuffer(msg, 0, 0, hides, shows, upds);
+	run<CPlayersUpdt>("CPlayersUpdt", msg);
+
+	std::vector<net::ToolAction<net::DAbsWPos>> abs;
+	std::vector<net::ToolAction<net::DRelWPos>> rel;
+	for (u32 i = 0; i < 50; i++) {
+		abs.emplace_back(i, rnd(1 << 16), rnd(1 << 16), net::TID_PENCIL, rnd(1 << 24));
+	}
+
+	for (u32 i = 0; i < 500; i++) {
+		rel.emplace_back(i, static_cast<i64>(rnd(32)) - 16, static_cast<i64>(rnd(32)) - 16, net::TID_PENCIL, rnd(1 << 24));
+	}
+
+	CToolActions::toBuffer(msg, abs, rel);
+	run<CToolActions>("CToolActions", msg);
+
+	std::vector<std::tuple<net::DAbsUpdAreaPos, net::DAbsUpdAreaPos>> areas;
+	for (i32 i = 0; i < 20; i++) {
+		areas.emplace_back(i % 5 - 2, i / 5 - 2);
+	}
+
+	CSubscribedAreas::toBuffer(msg, 7, areas);
+	run<CSubscribedAreas>("CSubscribedAreas", msg);
+	return 0;
+}
@@ -0,0 +1,56 @@
+// one CToolActions batch through StrokeApplier: painters drawing continuous strokes,
+// each moving about 16px per batch, spread over a few update areas
+
+#include <cstdio>
+#include <cmath>
+#include <vector>
+
+#include "bench.hpp"
+#include "cursor_env.hpp"
+#include "world/CursorStore.hpp"
+#include "world/StrokeApplier.hpp"
+
+int main() {
+	CursorStore cursors;
+	ToolManager& tm = fakeToolManager();
+	u32 writes = 0;
+	StrokeApplier sa(cursors, tm, [&] (Chunk::Pos, Chunk::Pos, const ChunkGlState::PxUpdate * px, sz_t n) {
+		keep(px);
+		++writes;
+		return true;
+	});
+
+	for (u32 painters : {50, 500}) {
+		std::vector<net::ToolAction<net::DAbsWPos>> abs(painters);
+		std::vector<net::ToolAction<net::DRelWPos>> rel;
+		u32 tick = 0;
+		auto nextBatch = [&] {
+			++tick;
+			for (u32 i = 0; i < painters; i++) {
+				// circles of different sizes, 16px of arc per tick
+				float r = 100.f + i % 7 * 40.f;
+				float a = tick * 16.f / r + i;
+				WorldPos x = (i % 20) * 400 + static_cast<WorldPos>(r * std::cos(a));
+				WorldPos y = (i / 20) * 400 + static_cast<WorldPos>(r * std::sin(a));
+				abs[i] = {i + 2, x, y, net::TID_PENCIL, fakePencilState(true, {{0, 0, 0, 255}})};
+			}
+		};
+
+		nextBatch();
+		sa.apply(abs, rel, 1);
+		writes = 0;
+		u32 batches = 0;
+		double us = timeUs([&] {
+			nextBatch();
+			sa.apply(abs, rel, 1);
+			++batches;
+		});
+
+		const auto& st = sa.getLastStats();
+		std::printf("%u painters, %u pixels into %u chunks per batch (%u chunk writes per batch on average):\n",
+				painters, st.pixels, st.chunks, writes / batches);
+		report("StrokeApplier::apply", us);
+	}
+
+	return 0;
+}
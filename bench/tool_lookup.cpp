@@ -0,0 +1,188 @@
+// resolving each cursor's tool icon, per frame. before the lookup table, every cursor went
+// through ToolManager::getSelectedTool (a visit of every tool), the tool's visual name and a
+// string search in Theme::tools. now it's an index into a table built when the theme loads.
+// Theme and the tools don't build outside the client, so both paths run on copies of their
+// data layouts here: the default theme's tool list, and virtual calls where the client makes them
+
+#include <array>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <string_view>
+
+#include "bench.hpp"
+
+struct StateInfo { // Theme::ToolStateInfo, minus the blob url
+	u16 hotspotX;
+	u16 hotspotY;
+	u16 atlasX;
+	u16 atlasY;
+	u16 atlasW;
+	u16 atlasH;
+};
+
+struct VisualInfo { // Theme::ToolVisualInfo
+	std::vector<StateInfo> states;
+	std::string name;
+	u16 column;
+	u16 hotspotX;
+	u16 hotspotY;
+	bool firstAsUiOnly;
+
+	const StateInfo& getState(u8 st) const {
+		return st < states.size() ? states[st] : states[0];
+	}
+};
+
+struct CurTool { // ToolStates, as far as the icon goes
+	u8 netId;
+	u8 state;
+};
+
+class Tool {
+public:
+	virtual ~Tool() = default;
+	virtual std::string_view getToolVisualName(const CurTool&) const = 0;
+	virtual u8 getToolVisualState(const CurTool& ts) const { return 0; }
+	virtual u8 getNetId() const = 0;
+};
+
+template<u8 Id>
+class NamedTool : public Tool {
+	std::string_view name;
+
+public:
+	NamedTool(std::string_view nName) : name(nName) { }
+	std::string_view getToolVisualName(const CurTool&) const override { return name; }
+	u8 getToolVisualState(const CurTool& ts) const override { return ts.state; }
+	u8 getNetId() const override { return Id; }
+};
+
+// the default theme's tools, in its order
+static const char * const toolNames[] = {"pencil", "move", "zoom", "pipette", "fill", "export", "ruler"};
+
+struct LutEntry { // CursorRendererGlState::ToolLutEntry
+	const Tool * tool;
+	u16 first;
+	u8 count;
+};
+
+struct Visual { // CursorRendererGlState::ToolVisual
+	float atlasX;
+	float atlasY;
+	float w;
+	float h;
+	float hotspotX;
+	float hotspotY;
+};
+
+int main() {
+	NamedTool<0> pencil("pencil");
+	NamedTool<1> move("move");
+	NamedTool<2> zoom("zoom");
+	NamedTool<3> pipette("pipette");
+	// the theme has icons for tools the client doesn't have yet
+	const std::array<const Tool *, 4> tools{&pencil, &move, &zoom, &pipette};
+
+	std::vector<VisualInfo> theme;
+	u16 col = 0;
+	for (const char * n : toolNames) {
+		VisualInfo vi{{}, n, col, 16, 16, false};
+		for (u16 s = 0; s < 2; s++) {
+			vi.states.push_back({16, 16, static_cast<u16>(col * 36), static_cast<u16>(s * 36), 32, 32});
+		}
+
+		theme.push_back(std::move(vi));
+		++col;
+	}
+
+	const float aw = 512.f;
+	const float ah = 128.f;
+
+	// built once per theme
+	std::vector<Visual> visuals;
+	std::array<LutEntry, 256> lut{};
+	for (const Tool * t : tools) {
+		auto it = std::find_if(theme.begin(), theme.end(), [t] (const VisualInfo& vi) {
+			return vi.name == t->getToolVisualName({});
+		});
+
+		LutEntry e{t, static_cast<u16>(visuals.size()), static_cast<u8>(it->states.size())};
+		for (const auto& si : it->states) {
+			visuals.push_back({si.atlasX / aw, si.atlasY / ah, static_cast<float>(si.atlasW),
+					static_cast<float>(si.atlasH), static_cast<float>(si.hotspotX), static_cast<float>(si.hotspotY)});
+		}
+
+		lut[t->getNetId()] = e;
+	}
+
+	std::printf("tool icon lookup, per frame:\n");
+	for (u32 n : {1000, 10000}) {
+		// mostly pencils, like a busy world
+		std::mt19937 rng(3);
+		std::discrete_distribution<u32> pick{70, 15, 5, 10};
+		std::vector<CurTool> cursors(n);
+		for (auto& c : cursors) {
+			c = {static_cast<u8>(pick(rng)), static_cast<u8>(rng() % 2)};
+		}
+
+		std::vector<float> out(n * 6);
+
+		double before = timeUs([&] {
+			float * o = out.data();
+			for (const CurTool& ts : cursors) {
+				const Tool * tool = nullptr;
+				for (const Tool * t : tools) { // ToolManager::getByNetId
+					if (ts.netId == t->getNetId()) {
+						tool = t;
+					}
+				}
+
+				auto vname = tool ? tool->getToolVisualName(ts) : "";
+				auto vstate = tool ? tool->getToolVisualState(ts) : 0;
+				const VisualInfo * ti = &*std::find_if(theme.begin(), theme.end(), [vname] (const VisualInfo& vi) {
+					return vi.name == vname;
+				});
+
+				const StateInfo& si = ti->getState(vstate);
+				o[0] = si.atlasX / aw;
+				o[1] = si.atlasY / ah;
+				o[2] = si.atlasW;
+				o[3] = si.atlasH;
+				o[4] = si.hotspotX;
+				o[5] = si.hotspotY;
+				o += 6;
+			}
+
+			keep(out);
+		});
+
+		double after = timeUs([&] {
+			float * o = out.data();
+			for (const CurTool& ts : cursors) {
+				const LutEntry& e = lut[ts.netId];
+				u8 vstate = e.tool ? e.tool->getToolVisualState(ts) : 0;
+				const Visual& v = visuals[e.first + (vstate < e.count ? vstate : 0)];
+				o[0] = v.atlasX;
+				o[1] = v.atlasY;
+				o[2] = v.w;
+				o[3] = v.h;
+				o[4] = v.hotspotX;
+				o[5] = v.hotspotY;
+				o += 6;
+			}
+
+			keep(out);
+		});
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "%u cursors, name search", n);
+		report(name, before);
+		std::snprintf(name, sizeof(name), "%u cursors, lookup table", n);
+		report(name, after);
+	}
+
+	return 0;
+}
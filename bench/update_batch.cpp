@@ -0,0 +1,138 @@
+// walking one CPlayersUpdt batch over a CursorStore: list by list, the way
+// World::handleUpdates does, against collecting the lists into one pid sorted op list so
+// each pid is looked up once. pids rarely repeat within a batch, so the sort is pure cost
+
+#include <cstdio>
+#include <tuple>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "bench.hpp"
+#include "cursor_env.hpp"
+#include "world/CursorStore.hpp"
+
+struct Batch {
+	std::vector<CursorStore::Id> hides;
+	std::vector<CursorStore::Id> updates;
+	std::vector<CursorStore::Id> shows;
+};
+
+enum OpKind : u8 { OP_HIDE, OP_UPDATE, OP_SHOW };
+
+struct Op {
+	CursorStore::Id pid;
+	OpKind kind;
+	u32 idx;
+};
+
+static void applyLists(CursorStore& cs, const Batch& b, ToolManager& tm) {
+	for (auto pid : b.hides) {
+		auto s = cs.find(pid);
+		if (s != CursorStore::npos) {
+			cs.remove(s);
+		}
+	}
+
+	for (auto pid : b.updates) {
+		auto s = cs.find(pid);
+		if (s != CursorStore::npos) {
+			cs.updateRel(s, 1, -1, 0, tm, 0, 0);
+		}
+	}
+
+	for (auto pid : b.shows) {
+		auto s = cs.find(pid);
+		if (s != CursorStore::npos) {
+			cs.update(s, 100, 100, 0, tm, 0, 0);
+		} else {
+			cs.insert(fakeUser(), pid, 100, 100, 0, tm, 0, 0);
+		}
+	}
+}
+
+static void applySorted(CursorStore& cs, const Batch& b, std::vector<Op>& ops, ToolManager& tm) {
+	ops.clear();
+	for (u32 i = 0; i < b.hides.size(); i++) {
+		ops.push_back({b.hides[i], OP_HIDE, i});
+	}
+
+	for (u32 i = 0; i < b.updates.size(); i++) {
+		ops.push_back({b.updates[i], OP_UPDATE, i});
+	}
+
+	for (u32 i = 0; i < b.shows.size(); i++) {
+		ops.push_back({b.shows[i], OP_SHOW, i});
+	}
+
+	std::sort(ops.begin(), ops.end(), [] (const Op& x, const Op& y) {
+		return std::tie(x.pid, x.kind, x.idx) < std::tie(y.pid, y.kind, y.idx);
+	});
+
+	for (sz_t i = 0; i < ops.size();) {
+		const auto pid = ops[i].pid;
+		auto s = cs.find(pid);
+		for (; i < ops.size() && ops[i].pid == pid; i++) {
+			switch (ops[i].kind) {
+			case OP_HIDE:
+				if (s != CursorStore::npos) {
+					cs.remove(s);
+					s = CursorStore::npos;
+				}
+				break;
+
+			case OP_UPDATE:
+				if (s != CursorStore::npos) {
+					cs.updateRel(s, 1, -1, 0, tm, 0, 0);
+				}
+				break;
+
+			case OP_SHOW:
+				if (s != CursorStore::npos) {
+					cs.update(s, 100, 100, 0, tm, 0, 0);
+				} else {
+					s = cs.insert(fakeUser(), pid, 100, 100, 0, tm, 0, 0);
+				}
+				break;
+			}
+		}
+	}
+}
+
+int main() {
+	ToolManager& tm = fakeToolManager();
+
+	for (u32 n : {50, 500, 5000}) {
+		std::mt19937 rng(7);
+		CursorStore lists;
+		CursorStore sorted;
+		std::vector<CursorStore::Id> live;
+		for (u32 i = 1; i <= n * 2; i++) {
+			CursorStore::Id id = i * 2654435761u;
+			WorldPos x = rng() % 2048;
+			WorldPos y = rng() % 2048;
+			live.emplace_back(id);
+			lists.insert(fakeUser(), id, x, y, 0, tm, 0, 0);
+			sorted.insert(fakeUser(), id, x, y, 0, tm, 0, 0);
+		}
+
+		// n updates, and a tenth as many cursors leaving and coming back
+		Batch b;
+		std::shuffle(live.begin(), live.end(), rng);
+		b.updates.assign(live.begin(), live.begin() + n);
+		b.hides.assign(live.begin() + n, live.begin() + n + n / 10);
+		b.shows = b.hides;
+
+		std::vector<Op> ops;
+		std::printf("%u updates, %u hides and shows:\n", n, n / 10);
+		report("list by list", timeUs([&] {
+			applyLists(lists, b, tm);
+		}));
+
+		report("one pid sorted op list", timeUs([&] {
+			applySorted(sorted, b, ops, tm);
+		}));
+	}
+
+	return 0;
+}
@@ -12,6 +12,7 @@
 
 #include "JsApiProxy.hpp"
 #include "PacketDefinitions.hpp"
+#include "Settings.hpp"
 #include "util/misc.hpp"
 #include "world/World.hpp"
 
@@ -76,7 +77,10 @@ Client::Client(JsApiProxy& api)
 #endif
   selfUid(0),
   tickTimer(emscripten_set_interval(Client::doTick, 1000.0 / Client::ticksPerSec, this)),
-  lastError(CE_NONE) {
+  lastPingAt(0.0),
+  lastError(CE_NONE),
+  recordingArmed(false),
+  recordingActive(false) {
 	std::printf("[Client] Created\n");
 	js_ws_on_open(Client::doWsOpen);
 	js_ws_on_close(Client::doWsClose);
@@ -123,6 +127,15 @@ Client::~Client() {
 }
 
 bool Client::open(std::string url, std::string_view worldToJoin) {
+	if (isReplaying()) {
+		return false;
+	}
+
+	if (replayer) {
+		replayer = nullptr;
+		resetSession();
+	}
+
 	setStatus("Connecting...");
 
 	url += '/';
@@ -140,6 +153,14 @@ void Client::close() {
 }
 
 void Client::send(std::unique_ptr<u8[]> buf, std::size_t len) {
+	if (replayer) {
+		return; // nobody to send to
+	}
+
+	if (recordingActive && !recording.append(TrafficLog::D_OUT, emscripten_get_now(), buf.get(), len)) {
+		recordingFull();
+	}
+
 	js_ws_send(reinterpret_cast<char*>(buf.get()), len);
 }
 
@@ -157,6 +178,80 @@ bool Client::freeMemory() {
 	return false;
 }
 
+const ClockSync& Client::getClockSync() const {
+	return clock;
+}
+
+void Client::startRecording(sz_t maxBytes) {
+	recording.setMaxBytes(maxBytes);
+	recording.clear();
+	recordingActive = false;
+	recordingArmed = true;
+
+	if (js_ws_get_ready_state() != EWsReadyState::CLOSED) {
+		std::puts("[Client] Recording will start on the next connection");
+	}
+}
+
+void Client::stopRecording() {
+	if (recordingActive) {
+		std::printf("[Client] Recording stopped, %zu frames (%zu bytes)\n",
+			recording.getFrameCount(), recording.get().size());
+	}
+
+	recordingArmed = false;
+	recordingActive = false;
+}
+
+void Client::recordingFull() {
+	std::printf("[Client] Recording reached its limit of %zu bytes\n", recording.getMaxBytes());
+	stopRecording();
+}
+
+bool Client::isRecording() const {
+	return recordingActive;
+}
+
+const TrafficLog& Client::getRecording() const {
+	return recording;
+}
+
+bool Client::replay(std::vector<u8> log, bool realtime) {
+	return replay(std::make_unique<TrafficLogSource>(std::move(log)), realtime);
+}
+
+bool Client::replay(std::unique_ptr<TrafficSource> source, bool realtime) {
+	if (js_ws_get_ready_state() != EWsReadyState::CLOSED || isReplaying()) {
+		std::fprintf(stderr, "[Client] Can't replay while connected or replaying\n");
+		return false;
+	}
+
+	replayer = nullptr;
+	resetSession();
+
+	sz_t droppedBefore = pr.getDroppedCount();
+	replayer = std::make_unique<TrafficReplayer>(std::move(source), realtime,
+		[this] (const u8 * buf, sz_t s) {
+			wsMessage(reinterpret_cast<const char *>(buf), s, false);
+		},
+		[this, droppedBefore] {
+			std::printf("[Client] Replay finished, %zu messages dropped, %zu cursors visible\n",
+				pr.getDroppedCount() - droppedBefore, world ? world->getCursors().size() : 0);
+		}
+	);
+
+	if (!replayer->start()) {
+		replayer = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+bool Client::isReplaying() const {
+	return replayer && !replayer->isFinished();
+}
+
 void Client::setStatus(std::string_view s) {
 	set_client_status(s.data(), s.size());
 }
@@ -208,8 +303,10 @@ void Client::registerPacketTypes() {
 		auto [cid, x, y, step, tid, tstate] = selfCur;
 		auto [arate, aper, aallowance] = action;
 		auto [crate, cper, callowance] = chat;
-		Bucket actionBkt(arate, aper, aallowance);
-		Bucket chatBkt(crate, cper, callowance);
+		// the server measured these when it sent them, they refilled on the way
+		float age = clock.getOneWayDelay() / 1000.0;
+		Bucket actionBkt(arate, aper, aallowance, age);
+		Bucket chatBkt(crate, cper, callowance, age);
 
 		std::printf(
 			"CPlayerData: ID=%llu X=%lld Y=%lld Step=%u ToolID=%u ABucketRate=%u ABucketPer=%u ABucketAllowance=%f "
@@ -251,6 +348,12 @@ void Client::registerPacketTypes() {
 		world->handleUpdates(uaX, uaY, std::move(hides), std::move(shows), std::move(updates));
 	});
 
+	pr.on<CToolActions>([this](std::vector<net::ToolAction<net::DAbsWPos>> abs, std::vector<net::ToolAction<net::DRelWPos>> rel) {
+		if (world) {
+			world->handleToolActions(abs, rel);
+		}
+	});
+
 	pr.on<CWorldData>(
 		[this](std::string worldName, std::string motd, u32 bgClr, bool restricted, std::optional<User::Id> owner) {
 			std::printf("WorldData: Name=%s BgClr=%X Restricted=%u Owner=", worldName.c_str(), bgClr, restricted);
@@ -287,10 +390,31 @@ void Client::registerPacketTypes() {
 
 		world->setSubscribedUpdateAreas(arseq, std::move(areas));
 	});
+
+	pr.on<CPong>([this](net::DPingSeq seq, double serverNow) {
+		bool wasSynced = clock.isSynced();
+		if (!clock.received(seq, serverNow, emscripten_get_now())) {
+			return;
+		}
+
+		if (!wasSynced && clock.isSynced()) {
+			const ClockSync::Stats& st = clock.getStats();
+			std::printf("[Client] Clock synced, offset: %.1fms, rtt: %.1fms\n", st.offset, st.minRtt);
+		}
+	});
 }
 
 void Client::tick() {
 	im.tick();
+
+	if (Settings::get().clockSync && !replayer && js_ws_get_ready_state() == EWsReadyState::OPEN) {
+		double now = emscripten_get_now();
+		if (now - lastPingAt >= pingIntervalMs) {
+			lastPingAt = now;
+			send(SPing::toBuffer(clock.sent(now)));
+		}
+	}
+
 	if (world) {
 		world->tick();
 	}
@@ -299,6 +423,13 @@ void Client::tick() {
 void Client::wsOpen() {
 	setStatus("Connected!");
 	std::puts("[Client] Ws opened");
+
+	if (recordingArmed) {
+		recordingArmed = false;
+		recordingActive = true;
+		recording.clear();
+		std::puts("[Client] Recording started");
+	}
 }
 
 void Client::wsClose(u16 code) {
@@ -355,13 +486,26 @@ void Client::wsClose(u16 code) {
 	set_loadscreen_visible(true);
 	std::printf("[Client] Ws closed: %u\n", code);
 
+	if (recordingActive) {
+		stopRecording(); // one session per log
+	}
+	resetSession();
+}
+
+void Client::resetSession() {
 	preJoinSelfCursorData = nullptr;
 	world = nullptr;
 	users.clear();
 	selfUid = 0;
+	clock.reset();
+	lastPingAt = 0.0;
 }
 
 void Client::wsMessage(const char* buf, sz_t s, bool) {
+	if (recordingActive && !recording.append(TrafficLog::D_IN, emscripten_get_now(), reinterpret_cast<const u8*>(buf), s)) {
+		recordingFull();
+	}
+
 	if (!pr.read(reinterpret_cast<const u8*>(buf), s)) {
 		std::fprintf(stderr, "[Client] Unknown message received, opcode: %u\n", buf[0]);
 	}
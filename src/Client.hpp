@@ -8,7 +8,10 @@
 
 #include "util/NonCopyable.hpp"
 #include "util/explints.hpp"
+#include "util/net/ClockSync.hpp"
 #include "util/net/PacketReader.hpp"
+#include "util/net/TrafficLog.hpp"
+#include "util/net/TrafficReplayer.hpp"
 #include "uvias/User.hpp"
 #include "world/SelfCursor.hpp"
 
@@ -23,6 +26,7 @@ class World;
 class Client : NonCopyable {
 public:
 	static constexpr double ticksPerSec = 20.0;
+	static constexpr double pingIntervalMs = 2000.0;
 
 private:
 	JsApiProxy& api;
@@ -32,12 +36,18 @@ private:
 	std::unordered_map<User::Id, User> users;
 	std::unique_ptr<World> world;
 	std::unique_ptr<SelfCursor::Builder> preJoinSelfCursorData;
+	TrafficLog recording;
+	std::unique_ptr<TrafficReplayer> replayer;
+	ClockSync clock;
 #if __has_feature(address_sanitizer)
 	ImAction iDoLeakCheck;
 #endif
 	User::Id selfUid;
 	long tickTimer;
+	double lastPingAt;
 	EConnectError lastError;
+	bool recordingArmed;
+	bool recordingActive;
 
 	decltype(Settings::enableAudio)::SlotKey skAudioEnableCh;
 	decltype(Settings::joinSfxVol)::SlotKey skJoinVolCh;
@@ -60,12 +70,29 @@ public:
 
 	bool freeMemory();
 
+	// rtt, jitter and the server clock offset of this connection
+	const ClockSync& getClockSync() const;
+
+	// a log is only replayable if it starts before joining, so when connected
+	// this waits for the next connection. recording stops by itself at maxBytes
+	void startRecording(sz_t maxBytes = TrafficLog::defaultMaxBytes);
+	void stopRecording();
+	bool isRecording() const;
+	const TrafficLog& getRecording() const;
+
+	// needs the ws to be closed, sends are dropped while replaying
+	bool replay(std::vector<u8> log, bool realtime);
+	bool replay(std::unique_ptr<TrafficSource>, bool realtime);
+	bool isReplaying() const;
+
 	static void setStatus(std::string_view);
 
 private:
 	void registerPacketTypes();
 
 	void tick();
+	void resetSession();
+	void recordingFull();
 
 	void wsOpen();
 	void wsClose(u16);
@@ -0,0 +1,267 @@
+#include "CrowdTrafficGen.hpp"
+
+#include <cstdio>
+#include <algorithm>
+#include <utility>
+
+#include "world/World.hpp"
+
+// rgb565 red, full alpha (3 bits), clicking
+static constexpr u64 pencilClickState = 0xF800 | (7 << 16) | (1 << 19);
+
+CrowdTrafficGen::CrowdTrafficGen(Config c)
+: cfg(c),
+  framesReady(0),
+  nextFrame(0),
+  tick(0),
+  nextPid(1), // 0 is us
+  rngState(c.seed ? c.seed : 1),
+  minPos(0),
+  maxPos(0),
+  totals{},
+  done(false) {
+	cfg.areasSide = std::clamp<u32>(cfg.areasSide, 1, 16);
+
+	i32 lo = -i32(cfg.areasSide / 2);
+	i32 hi = lo + i32(cfg.areasSide) - 1;
+	for (i32 y = lo; y <= hi; y++) {
+		for (i32 x = lo; x <= hi; x++) {
+			areas.emplace_back(mk_twoi32(x, y));
+		}
+	}
+
+	std::sort(areas.begin(), areas.end());
+	batches.resize(areas.size());
+
+	// cursors roam one ring of areas further than what we're subscribed to
+	minPos = (lo - 1) * World::updateAreaSize;
+	maxPos = (hi + 2) * World::updateAreaSize - 1;
+
+	crowd.resize(cfg.cursors);
+	for (SimCursor& sc : crowd) {
+		spawn(sc);
+	}
+
+	genPreamble();
+}
+
+bool CrowdTrafficGen::next(TrafficLog::Frame& f) {
+	while (nextFrame == framesReady) {
+		if (tick >= cfg.ticks) {
+			if (!done) {
+				done = true;
+				std::printf("[CrowdTrafficGen] %u cursors, %u ticks: %llu shows, %llu hides, %llu updates, "
+					"%llu crossings, %llu exits, %llu tool actions, %llu bytes\n",
+					cfg.cursors, cfg.ticks, totals.shows, totals.hides, totals.updates,
+					totals.crossings, totals.exits, totals.toolActions, totals.bytes);
+			}
+
+			return false;
+		}
+
+		genTick();
+	}
+
+	const auto& buf = frames[nextFrame++];
+	f.dir = TrafficLog::D_IN;
+	f.ts = tick * tickMs;
+	f.data = buf.data();
+	f.size = buf.size();
+	return true;
+}
+
+bool CrowdTrafficGen::ok() const {
+	return true;
+}
+
+const CrowdTrafficGen::Totals& CrowdTrafficGen::getTotals() const {
+	return totals;
+}
+
+void CrowdTrafficGen::genPreamble() {
+	framesReady = nextFrame = 0;
+
+	CAuthOk::toBuffer(nextFrameBuf(), {1, "crowd", 0, 0, "User", false, false});
+	CPlayerData::toBuffer(nextFrameBuf(), {0, 0, 0, 0, net::TID_MOVE, 0},
+		{32, 4, 32.f}, {4, 6, 4.f}, false, false, 0, 0);
+	CWorldData::toBuffer(nextFrameBuf(), "crowd", "synthetic crowd", 0xFFFFFF, true, std::nullopt);
+
+	std::vector<std::tuple<net::DAbsUpdAreaPos, net::DAbsUpdAreaPos>> areasV;
+	areasV.reserve(areas.size());
+	for (twoi32 a : areas) {
+		areasV.emplace_back(a.c.x, a.c.y);
+	}
+
+	CSubscribedAreas::toBuffer(nextFrameBuf(), 0, areasV);
+
+	// initial crowd, everyone is new
+	for (const SimCursor& sc : crowd) {
+		if (AreaBatch * b = batchAt(sc.x, sc.y)) {
+			b->shows.emplace_back(sc.pid, net::PlayerUpd<net::DAbsWPos>{sc.pid, sc.x, sc.y, 0, sc.tid, 0});
+			++totals.shows;
+		}
+	}
+
+	for (sz_t i = 0; i < areas.size(); i++) {
+		AreaBatch& b = batches[i];
+		if (!b.shows.empty()) {
+			CPlayersUpdt::toBuffer(nextFrameBuf(), areas[i].c.x, areas[i].c.y, b.hides, b.shows, b.updates);
+			b.shows.clear();
+		}
+	}
+
+	for (sz_t i = 0; i < framesReady; i++) {
+		totals.bytes += frames[i].size();
+	}
+}
+
+void CrowdTrafficGen::genTick() {
+	++tick;
+	framesReady = nextFrame = 0;
+	toolActions.clear();
+
+	for (SimCursor& sc : crowd) {
+		if (randf() < cfg.churn) {
+			if (AreaBatch * b = batchAt(sc.x, sc.y)) {
+				b->hides.emplace_back(sc.pid);
+				++totals.hides;
+			}
+
+			spawn(sc);
+			if (AreaBatch * b = batchAt(sc.x, sc.y)) {
+				b->shows.emplace_back(sc.pid, net::PlayerUpd<net::DAbsWPos>{sc.pid, sc.x, sc.y, 0, sc.tid, 0});
+				++totals.shows;
+			}
+
+			continue;
+		}
+
+		if (randf() >= cfg.moveChance) {
+			continue;
+		}
+
+		i32 oldX = sc.x;
+		i32 oldY = sc.y;
+		AreaBatch * from = batchAt(oldX, oldY);
+		move(sc);
+		AreaBatch * to = batchAt(sc.x, sc.y);
+
+		if (World::updAreaOf(oldX, oldY) != World::updAreaOf(sc.x, sc.y)) {
+			++totals.crossings;
+			// server sends a final relative update on the old area and the full
+			// cursor on the new one, the client may get them in any order
+			if (to) {
+				to->shows.emplace_back(sc.pid, net::PlayerUpd<net::DAbsWPos>{sc.pid, sc.x, sc.y, 0, sc.tid, 0});
+				++totals.shows;
+			} else if (from) {
+				++totals.exits;
+			}
+		}
+
+		if (from) {
+			from->updates.emplace_back(sc.pid, sc.x - oldX, sc.y - oldY, 0, sc.tid, 0);
+			++totals.updates;
+		}
+	}
+
+	for (u32 i = 0; i < cfg.toolActionsPerTick && !crowd.empty(); i++) {
+		const SimCursor& sc = crowd[rand() % crowd.size()];
+		if (batchAt(sc.x, sc.y)) {
+			toolActions.emplace_back(sc.pid, randRange(-8, 8), randRange(-8, 8), net::TID_PENCIL, pencilClickState);
+			++totals.toolActions;
+		}
+	}
+
+	for (sz_t i = 0; i < areas.size(); i++) {
+		AreaBatch& b = batches[i];
+		if (b.hides.empty() && b.shows.empty() && b.updates.empty()) {
+			continue;
+		}
+
+		CPlayersUpdt::toBuffer(nextFrameBuf(), areas[i].c.x, areas[i].c.y, b.hides, b.shows, b.updates);
+		b.hides.clear();
+		b.shows.clear();
+		b.updates.clear();
+	}
+
+	// per area streams aren't ordered relative to each other
+	for (sz_t i = framesReady; i > 1; i--) {
+		std::swap(frames[i - 1], frames[rand() % i]);
+	}
+
+	if (!toolActions.empty()) {
+		CToolActions::toBuffer(nextFrameBuf(), {}, toolActions);
+	}
+
+	for (sz_t i = 0; i < framesReady; i++) {
+		totals.bytes += frames[i].size();
+	}
+}
+
+void CrowdTrafficGen::spawn(SimCursor& sc) {
+	sc.pid = nextPid++;
+	sc.x = randRange(minPos, maxPos);
+	sc.y = randRange(minPos, maxPos);
+	sc.vx = 0;
+	sc.vy = 0;
+	sc.tid = rand() & 1 ? net::TID_PENCIL : net::TID_MOVE;
+}
+
+void CrowdTrafficGen::move(SimCursor& sc) {
+	i32 speed = cfg.speed;
+	// keep some heading so cursors actually travel across areas
+	sc.vx = std::clamp(sc.vx + randRange(-speed / 4, speed / 4), -speed, speed);
+	sc.vy = std::clamp(sc.vy + randRange(-speed / 4, speed / 4), -speed, speed);
+
+	sc.x += sc.vx;
+	sc.y += sc.vy;
+
+	if (sc.x < minPos || sc.x > maxPos) {
+		sc.vx = -sc.vx;
+		sc.x = std::clamp(sc.x, minPos, maxPos);
+	}
+
+	if (sc.y < minPos || sc.y > maxPos) {
+		sc.vy = -sc.vy;
+		sc.y = std::clamp(sc.y, minPos, maxPos);
+	}
+}
+
+CrowdTrafficGen::AreaBatch * CrowdTrafficGen::batchAt(i32 x, i32 y) {
+	twoi32 ua = World::updAreaOf(x, y);
+	auto it = std::lower_bound(areas.begin(), areas.end(), ua);
+	if (it == areas.end() || *it != ua) {
+		return nullptr;
+	}
+
+	return &batches[it - areas.begin()];
+}
+
+std::vector<u8>& CrowdTrafficGen::nextFrameBuf() {
+	if (framesReady == frames.size()) {
+		frames.emplace_back();
+	}
+
+	return frames[framesReady++];
+}
+
+u32 CrowdTrafficGen::rand() {
+	// xorshift32, deterministic across runs for the same seed
+	u32 x = rngState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return rngState = x;
+}
+
+float CrowdTrafficGen::randf() {
+	return (rand() >> 8) * (1.f / 16777216.f);
+}
+
+i32 CrowdTrafficGen::randRange(i32 min, i32 max) {
+	if (max <= min) {
+		return min;
+	}
+
+	return min + i32(rand() % u32(max - min + 1));
+}
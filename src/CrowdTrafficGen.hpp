@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+
+#include "util/explints.hpp"
+#include "util/misc.hpp"
+#include "util/net/TrafficReplayer.hpp"
+#include "PacketDefinitions.hpp"
+
+// synthesizes the packets a server would send to a client following a crowd,
+// one batch per server tick. per area packets of a tick are shuffled, so
+// cursors crossing update areas hit both orderings handleUpdates deals with.
+class CrowdTrafficGen : public TrafficSource {
+public:
+	struct Config {
+		u32 cursors;
+		u32 ticks;
+		u32 areasSide; // subscribed areas form a square of this side around 0,0
+		u32 speed; // max pixels moved per tick
+		float moveChance;
+		float churn; // chance per tick of a cursor leaving and a new one joining
+		u32 toolActionsPerTick;
+		u32 seed;
+	};
+
+	struct Totals {
+		u64 shows;
+		u64 hides;
+		u64 updates;
+		u64 crossings;
+		u64 exits; // left the subscribed areas
+		u64 toolActions;
+		u64 bytes;
+	};
+
+	static constexpr double tickMs = 50.0;
+
+private:
+	struct SimCursor {
+		u64 pid;
+		i32 x;
+		i32 y;
+		i32 vx;
+		i32 vy;
+		u8 tid;
+	};
+
+	struct AreaBatch {
+		net::VPlayersHide hides;
+		net::VPlayersShow shows;
+		net::VPlayersUpdate updates;
+	};
+
+	Config cfg;
+	std::vector<SimCursor> crowd;
+	std::vector<twoi32> areas; // sorted
+	std::vector<AreaBatch> batches; // same indices as areas
+	std::vector<std::vector<u8>> frames;
+	std::vector<net::ToolAction<net::DRelWPos>> toolActions;
+	sz_t framesReady;
+	sz_t nextFrame;
+	u32 tick;
+	u64 nextPid;
+	u32 rngState;
+	i32 minPos;
+	i32 maxPos;
+	Totals totals;
+	bool done;
+
+public:
+	CrowdTrafficGen(Config);
+
+	bool next(TrafficLog::Frame&) override;
+	bool ok() const override;
+
+	const Totals& getTotals() const;
+
+private:
+	void genPreamble();
+	void genTick();
+	void spawn(SimCursor&);
+	void move(SimCursor&);
+	AreaBatch * batchAt(i32 x, i32 y);
+	std::vector<u8>& nextFrameBuf();
+
+	u32 rand();
+	float randf();
+	i32 randRange(i32 min, i32 max);
+};
@@ -0,0 +1,212 @@
+#ifdef FRAME_PROFILER
+
+#include "FrameProfiler.hpp"
+
+#include <cstdio>
+#include <algorithm>
+
+#include <emscripten.h>
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+
+FrameProfiler::Scope::Scope(Phase p)
+: start(emscripten_get_now()),
+  p(p) {
+	FrameProfiler::get().begin(p);
+}
+
+FrameProfiler::Scope::~Scope() {
+	FrameProfiler::get().end(p, emscripten_get_now() - start);
+}
+
+FrameProfiler::FrameProfiler()
+: frames{},
+  queries{},
+  frameSerial(0),
+  recorded(0),
+  inFrame(false),
+  gpuTimers(false) { }
+
+FrameProfiler& FrameProfiler::get() {
+	static FrameProfiler fp;
+	return fp;
+}
+
+void FrameProfiler::resetGl(bool timerQueries) {
+	destroyGl();
+	gpuTimers = timerQueries;
+	if (!gpuTimers) {
+		return;
+	}
+
+	for (auto& qs : queries) {
+		glGenQueries(qs.q.size(), qs.q.data());
+	}
+
+	std::printf("[FrameProfiler] Using gpu timer queries\n");
+}
+
+void FrameProfiler::destroyGl() {
+	if (gpuTimers) {
+		for (auto& qs : queries) {
+			glDeleteQueries(qs.q.size(), qs.q.data());
+		}
+	}
+
+	queries = {};
+	gpuTimers = false;
+}
+
+void FrameProfiler::begin(Phase p) {
+	if (p == P_FRAME) {
+		beginFrame();
+	} else if (!inFrame) {
+		return;
+	}
+
+	if (gpuTimers && gpuPhases[p]) {
+		QuerySet& qs = currentQueries();
+		glBeginQuery(GL_TIME_ELAPSED_EXT, qs.q[p]);
+		qs.used[p] = true;
+	}
+}
+
+void FrameProfiler::end(Phase p, double cpuMs) {
+	if (!inFrame) {
+		return;
+	}
+
+	if (gpuTimers && gpuPhases[p]) {
+		glEndQuery(GL_TIME_ELAPSED_EXT);
+		currentQueries().pending = true;
+	}
+
+	float& ms = frames[frameSerial % maxFrames].cpuMs[p];
+	ms = std::max(ms, 0.f) + cpuMs; // phases may run more than once
+
+	if (p == P_FRAME) {
+		endFrame();
+	}
+}
+
+bool FrameProfiler::hasGpuTimers() const {
+	return gpuTimers;
+}
+
+sz_t FrameProfiler::getFrameCount() const {
+	return recorded;
+}
+
+const FrameProfiler::Frame& FrameProfiler::getFrame(sz_t age) const {
+	// the newest complete frame is the one at frameSerial, unless one is being recorded
+	u32 newest = inFrame ? frameSerial - 1 : frameSerial;
+	return frames[(newest - age) % maxFrames];
+}
+
+float FrameProfiler::percentile(Phase p, bool gpu, float pc) const {
+	std::array<float, maxFrames> v;
+	sz_t n = 0;
+	for (sz_t i = 0; i < recorded; i++) {
+		const Frame& f = getFrame(i);
+		float ms = gpu ? f.gpuMs[p] : f.cpuMs[p];
+		if (ms >= 0.f) {
+			v[n++] = ms;
+		}
+	}
+
+	if (n == 0) {
+		return -1.f;
+	}
+
+	sz_t k = std::min<sz_t>(pc * n, n - 1);
+	std::nth_element(v.begin(), v.begin() + k, v.begin() + n);
+	return v[k];
+}
+
+const char * FrameProfiler::getPhaseName(Phase p) {
+	switch (p) {
+		case P_FRAME: return "frame";
+		case P_PRE_RENDER: return "preRender";
+		case P_CHUNK_UPDATES: return "chunkUpdates";
+		case P_CHUNK_DRAW: return "chunkDraw";
+		case P_CURSORS: return "cursors";
+		case P_UI: return "ui";
+		default: return "?";
+	}
+}
+
+void FrameProfiler::beginFrame() {
+	collectQueries();
+
+	++frameSerial;
+	Frame& f = frames[frameSerial % maxFrames];
+	f.cpuMs.fill(-1.f);
+	f.gpuMs.fill(-1.f);
+
+	// a set whose results never came back is dropped, restarting a query discards them
+	QuerySet& qs = currentQueries();
+	qs.used.fill(false);
+	qs.frameSerial = frameSerial;
+	qs.pending = false;
+
+	inFrame = true;
+}
+
+void FrameProfiler::endFrame() {
+	inFrame = false;
+	recorded = std::min<u32>(recorded + 1, maxFrames);
+}
+
+FrameProfiler::QuerySet& FrameProfiler::currentQueries() {
+	return queries[frameSerial % maxQueriesInFlight];
+}
+
+void FrameProfiler::collectQueries() {
+	if (!gpuTimers) {
+		return;
+	}
+
+	GLint disjoint = 0;
+	glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+	for (auto& qs : queries) {
+		if (!qs.pending) {
+			continue;
+		}
+
+		if (disjoint) {
+			qs.pending = false; // timings are garbage, the gpu got interrupted
+			continue;
+		}
+
+		bool available = true;
+		for (u8 p = 0; p < P_NUM && available; p++) {
+			GLuint av = GL_TRUE;
+			if (qs.used[p]) {
+				glGetQueryObjectuiv(qs.q[p], GL_QUERY_RESULT_AVAILABLE, &av);
+			}
+
+			available = av == GL_TRUE;
+		}
+
+		if (!available) {
+			continue;
+		}
+
+		qs.pending = false;
+		if (frameSerial - qs.frameSerial >= maxFrames) {
+			continue; // the frame fell out of the ring
+		}
+
+		Frame& f = frames[qs.frameSerial % maxFrames];
+		for (u8 p = 0; p < P_NUM; p++) {
+			if (qs.used[p]) {
+				GLuint ns = 0;
+				glGetQueryObjectuiv(qs.q[p], GL_QUERY_RESULT, &ns);
+				f.gpuMs[p] = ns / 1000000.f;
+			}
+		}
+	}
+}
+
+#endif
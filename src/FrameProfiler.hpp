@@ -0,0 +1,99 @@
+#pragma once
+
+// build with `make FRAME_PROFILER=1` to enable. otherwise the PROF_ macros expand to
+// nothing and none of this gets compiled.
+#ifdef FRAME_PROFILER
+
+#include <array>
+
+#include "util/explints.hpp"
+
+class FrameProfiler {
+public:
+	enum Phase : u8 {
+		P_FRAME, // all of Renderer::render
+		P_PRE_RENDER,
+		P_CHUNK_UPDATES,
+		P_CHUNK_DRAW,
+		P_CURSORS,
+		P_UI,
+		P_NUM
+	};
+
+	static constexpr sz_t maxFrames = 240;
+	static constexpr sz_t maxQueriesInFlight = 4; // frames the gpu results can lag behind
+
+	// negative if the phase didn't run that frame. gpu times also stay negative until the
+	// query result comes back, or always without timer queries
+	struct Frame {
+		std::array<float, P_NUM> cpuMs;
+		std::array<float, P_NUM> gpuMs;
+	};
+
+	class Scope {
+		double start;
+		Phase p;
+
+	public:
+		Scope(Phase);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+
+private:
+	// only the phases that don't overlap can have a query, gl can't nest them
+	static constexpr std::array<bool, P_NUM> gpuPhases{false, false, true, true, true, false};
+
+	struct QuerySet {
+		std::array<u32, P_NUM> q;
+		std::array<bool, P_NUM> used;
+		u32 frameSerial;
+		bool pending;
+	};
+
+	std::array<Frame, maxFrames> frames;
+	std::array<QuerySet, maxQueriesInFlight> queries;
+	u32 frameSerial; // of the frame being recorded, its slot is frameSerial % maxFrames
+	u32 recorded;
+	bool inFrame;
+	bool gpuTimers;
+
+	FrameProfiler();
+
+public:
+	static FrameProfiler& get();
+
+	// for every new context. timer queries need EXT_disjoint_timer_query_webgl2
+	void resetGl(bool timerQueries);
+	void destroyGl();
+
+	void begin(Phase);
+	void end(Phase, double cpuMs);
+
+	bool hasGpuTimers() const;
+	sz_t getFrameCount() const;
+	// 0 is the newest frame
+	const Frame& getFrame(sz_t age) const;
+	// percentile p (0 to 1) over the recorded frames, negative if no samples
+	float percentile(Phase, bool gpu, float p) const;
+
+	static const char * getPhaseName(Phase);
+
+private:
+	void beginFrame();
+	void endFrame();
+	QuerySet& currentQueries();
+	void collectQueries();
+};
+
+#define PROF_CAT2(a, b) a##b
+#define PROF_CAT(a, b) PROF_CAT2(a, b)
+#define PROF_SCOPE(phase) FrameProfiler::Scope PROF_CAT(profScope, __LINE__){FrameProfiler::phase}
+
+#else
+
+#define PROF_SCOPE(phase) do { } while (0)
+
+#endif
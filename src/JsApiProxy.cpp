@@ -2,12 +2,16 @@
 
 #include <memory>
 #include <cstdio>
+#include <vector>
 
 #include <emscripten.h>
 
 #include "util/explints.hpp"
 
 #include "Client.hpp"
+#include "CrowdTrafficGen.hpp"
+#include "Renderer.hpp"
+#include "FrameProfiler.hpp"
 #include "world/World.hpp"
 
 EM_JS(void, create_api_structure, (void), {
@@ -36,12 +40,245 @@ EM_JS(void, create_api_structure, (void), {
 			"getName": sf("owop_api_get_world_name"),
 			"getPixel": uf("owop_api_get_pixel"),
 			"setPixel": f("owop_api_set_pixel"),
+			"getCursorPrediction": f("owop_api_get_cursor_prediction"),
+			"setCursorPrediction": f("owop_api_set_cursor_prediction"),
 			get ["name"]() { return this["getName"](); }
 		},
 		"client": {
 			"reconnect": f("owop_api_reconnect"),
+			"close": f("owop_api_close"),
+			"startRecording": function(maxBytes) {
+				f("owop_api_start_recording")(maxBytes || 0);
+			},
+			"stopRecording": function() {
+				f("owop_api_stop_recording")();
+				var ptr = f("owop_api_get_recording_ptr")();
+				var size = f("owop_api_get_recording_size")() >>> 0;
+				return HEAPU8.slice(ptr, ptr + size);
+			},
+			"replay": function(log, realtime) {
+				var data = new Uint8Array(log);
+				var ptr = f("owop_api_replay_buffer")(data.length);
+				if (!ptr) {
+					return false;
+				}
+
+				HEAPU8.set(data, ptr);
+				return f("owop_api_replay")(!!realtime);
+			},
+			"crowdBench": function(opts) {
+				opts = opts || {};
+				var get = function(k, def) { return opts[k] !== undefined ? opts[k] : def; };
+				return f("owop_api_crowd_bench")(
+					get("cursors", 1000), get("ticks", 200), get("areasSide", 4), get("speed", 64),
+					get("moveChance", 0.5), get("churn", 0.002), get("toolActions", 100), get("seed", 1),
+					!!get("realtime", false)
+				);
+			},
+			"getNetStats": function() {
+				return {
+					"rtt": f("owop_api_get_rtt")(),
+					"srtt": f("owop_api_get_srtt")(),
+					"minRtt": f("owop_api_get_min_rtt")(),
+					"jitter": f("owop_api_get_rtt_jitter")(),
+					"clockOffset": f("owop_api_get_clock_offset")(),
+					"serverTime": f("owop_api_get_server_time")(),
+					"synced": !!f("owop_api_is_clock_synced")(),
+					"samples": uf("owop_api_get_ping_samples")(),
+					"lost": uf("owop_api_get_pings_lost")()
+				};
+			},
 			get ["ws"]() { return Module.JSWS.ws; }
 		},
+		"renderer": {
+			"getCursorStats": function() {
+				return {
+					"drawn": uf("owop_api_get_cursors_drawn")(),
+					"culled": uf("owop_api_get_cursors_culled")(),
+					"rewritten": uf("owop_api_get_cursors_rewritten")(),
+					"crowds": uf("owop_api_get_cursor_crowds")()
+				};
+			},
+			"getDrawStats": function() {
+				return {
+					"drawCalls": uf("owop_api_get_draw_calls")(),
+					"chunks": uf("owop_api_get_chunks_drawn")(),
+					"pooledChunks": uf("owop_api_get_pooled_chunks")(),
+					"pooledProtections": uf("owop_api_get_pooled_protections")(),
+					"fullFrames": uf("owop_api_get_full_frames")(),
+					"partialFrames": uf("owop_api_get_partial_frames")(),
+					"cursorOnlyFrames": uf("owop_api_get_cursor_only_frames")(),
+					"renderScale": f("owop_api_get_render_scale")(),
+					"renderScaleChanges": uf("owop_api_get_render_scale_changes")()
+				};
+			},
+			"getUploadStats": function() {
+				return {
+					"instanced": uf("owop_api_get_instanced_uploads")(),
+					"subImage": uf("owop_api_get_sub_image_uploads")(),
+					"pxCost": f("owop_api_get_upload_px_cost")()
+				};
+			},
+			"setUploadPxCost": f("owop_api_set_upload_px_cost"),
+			"uploadBench": function(opts) {
+				opts = opts || {};
+				var get = function(k, def) { return opts[k] !== undefined ? opts[k] : def; };
+				var bench = function(strat) {
+					return f("owop_api_upload_bench")(get("pixels", 4096), get("frames", 100), !!get("sparse", false), strat);
+				};
+				return { "instanced": bench(1), "subImage": bench(2), "auto": bench(0) };
+			},
+			/* grid = 1, invert = 2, smooth = 4. force with a mask, or null to pick from the
+			 * settings and zoom again */
+			"getChunkShaderVariant": function() {
+				return {
+					"variant": f("owop_api_get_chunk_variant")(),
+					"built": f("owop_api_get_built_chunk_variants")()
+				};
+			},
+			"forceChunkShaderVariant": function(v) {
+				f("owop_api_force_chunk_variant")(v === null || v === undefined ? -1 : v);
+			},
+			/* resolves with frame times and checksums. opts.golden is the result of an
+			 * earlier run to compare against: it rejects, with the result in error.result,
+			 * if any checksum differs or the runs can't be compared. it also rejects if the
+			 * default path isn't the one the build was checked against */
+			"renderBench": function(opts) {
+				opts = opts || {};
+				/* defaults are RenderBench::defaultConfig */
+				var get = function(k, def) { return opts[k] !== undefined ? opts[k] : def; };
+				if (!f("owop_api_render_bench_start")(get("frames", 600), get("seed", 1), get("radius", 1.5),
+						get("checksumEvery", 30), !!get("cursors", false))) {
+					return Promise.reject(new Error("Couldn't start the render bench, check the console"));
+				}
+
+				return new Promise(function(resolve, reject) {
+					var poll = function() {
+						if (f("owop_api_render_bench_running")()) {
+							requestAnimationFrame(poll);
+							return;
+						}
+
+						var sums = [];
+						for (var i = 0, n = f("owop_api_render_bench_checksums")(); i < n; i++) {
+							sums.push(uf("owop_api_render_bench_checksum")(i));
+						}
+
+						var res = {
+							"frames": f("owop_api_render_bench_stat")(0),
+							"width": f("owop_api_render_bench_stat")(1),
+							"height": f("owop_api_render_bench_stat")(2),
+							"avgMs": f("owop_api_render_bench_stat")(3),
+							"p50Ms": f("owop_api_render_bench_stat")(4),
+							"p99Ms": f("owop_api_render_bench_stat")(5),
+							"maxMs": f("owop_api_render_bench_stat")(6),
+							"scene": uf("owop_api_render_bench_stat")(7),
+							"checksums": sums
+						};
+
+						var fail = function(why) {
+							var e = new Error("Render bench failed: " + why);
+							e["result"] = res;
+							reject(e);
+						};
+
+						var expected = f("owop_api_render_bench_stat")(8);
+						if (expected && expected !== res["scene"]) {
+							return fail("scene " + res["scene"] + " isn't the reference " + expected);
+						}
+
+						var golden = get("golden", null);
+						if (golden) {
+							if (golden["scene"] !== res["scene"]) {
+								return fail("the golden run has another scene");
+							}
+
+							if (golden["width"] !== res["width"] || golden["height"] !== res["height"]) {
+								return fail("the golden run was " + golden["width"] + "x" + golden["height"]);
+							}
+
+							res["mismatches"] = sums.map(function(s, i) { return s === golden["checksums"][i] ? -1 : i; })
+								.filter(function(i) { return i >= 0; });
+							if (res["mismatches"].length || sums.length !== golden["checksums"].length) {
+								return fail("checksums differ at " + res["mismatches"].join(", "));
+							}
+						}
+
+						resolve(res);
+					};
+
+					requestAnimationFrame(poll);
+				});
+			},
+			/* null unless built with FRAME_PROFILER=1 */
+			"getProfile": function() {
+				if (!f("owop_api_prof_frames")) {
+					return null;
+				}
+
+				var ph = {};
+				for (var p = 0, n = f("owop_api_prof_phases")(); p < n; p++) {
+					ph[UTF8ToString(f("owop_api_prof_phase_name")(p))] = {
+						"cpuP50": f("owop_api_prof_percentile")(p, false, 0.5),
+						"cpuP99": f("owop_api_prof_percentile")(p, false, 0.99),
+						"gpuP50": f("owop_api_prof_percentile")(p, true, 0.5),
+						"gpuP99": f("owop_api_prof_percentile")(p, true, 0.99)
+					};
+				}
+
+				return { "frames": f("owop_api_prof_frames")(), "gpuTimers": !!f("owop_api_prof_has_gpu_timers")(), "phases": ph };
+			},
+			/* age 0 is the newest frame, negative times mean the phase didn't run */
+			"getProfileFrame": function(age) {
+				if (!f("owop_api_prof_frames") || age >= f("owop_api_prof_frames")()) {
+					return null;
+				}
+
+				var fr = {};
+				for (var p = 0, n = f("owop_api_prof_phases")(); p < n; p++) {
+					fr[UTF8ToString(f("owop_api_prof_phase_name")(p))] = {
+						"cpu": f("owop_api_prof_frame_ms")(age, p, false),
+						"gpu": f("owop_api_prof_frame_ms")(age, p, true)
+					};
+				}
+
+				return fr;
+			},
+			"showProfiler": function(show) {
+				var api = this;
+				if (api._profEl) {
+					clearInterval(api._profTimer);
+					api._profEl.remove();
+					api._profEl = null;
+				}
+
+				if (show === false || !api["getProfile"]()) {
+					return false;
+				}
+
+				var el = api._profEl = document.createElement("pre");
+				el.style.cssText = "position:fixed;left:4px;bottom:4px;margin:0;padding:4px;z-index:1000;"
+					+ "pointer-events:none;background:rgba(0,0,0,.7);color:#fff;font:11px monospace";
+				document.body.appendChild(el);
+
+				var ms = function(v) { return v < 0 ? "    -" : v.toFixed(2).padStart(5); };
+				var draw = function() {
+					var pr = api["getProfile"]();
+					var txt = "phase         cpu p50   p99 | gpu p50   p99  (" + pr["frames"] + " frames)\n";
+					for (var k in pr["phases"]) {
+						var v = pr["phases"][k];
+						txt += k.padEnd(13) + "  " + ms(v["cpuP50"]) + " " + ms(v["cpuP99"])
+							+ " |   " + ms(v["gpuP50"]) + " " + ms(v["gpuP99"]) + "\n";
+					}
+
+					el.textContent = txt;
+				};
+
+				draw();
+				api._profTimer = setInterval(draw, 500);
+				return true;
+			}
+		},
 		"chat": {},
 		"player": {},
 		"camera": {
@@ -91,6 +328,20 @@ u32 owop_api_get_pixel(World::Pos x, World::Pos y) {
 	return w ? w->getPixel(x, y).rgb : 0;
 }
 
+EMSCRIPTEN_KEEPALIVE
+float owop_api_get_cursor_prediction(void) {
+	World * w = JsApiProxy::getWorld();
+	return w ? w->getCursorPredictionHorizon() : 0.f;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void owop_api_set_cursor_prediction(float ms) {
+	World * w = JsApiProxy::getWorld();
+	if (w) {
+		w->setCursorPredictionHorizon(ms);
+	}
+}
+
 /******
  * CLIENT API
  ******/
@@ -105,6 +356,358 @@ bool owop_api_reconnect(void) {
 	return c->reconnect();
 }
 
+EMSCRIPTEN_KEEPALIVE
+void owop_api_close(void) {
+	if (Client * c = JsApiProxy::getClient()) {
+		c->close();
+	}
+}
+
+EMSCRIPTEN_KEEPALIVE
+void owop_api_start_recording(u32 maxBytes) {
+	if (Client * c = JsApiProxy::getClient()) {
+		c->startRecording(maxBytes ? maxBytes : TrafficLog::defaultMaxBytes);
+	}
+}
+
+EMSCRIPTEN_KEEPALIVE
+void owop_api_stop_recording(void) {
+	if (Client * c = JsApiProxy::getClient()) {
+		c->stopRecording();
+	}
+}
+
+EMSCRIPTEN_KEEPALIVE
+const u8 * owop_api_get_recording_ptr(void) {
+	Client * c = JsApiProxy::getClient();
+	return c ? c->getRecording().get().data() : nullptr;
+}
+
+EMSCRIPTEN_KEEPALIVE
+sz_t owop_api_get_recording_size(void) {
+	Client * c = JsApiProxy::getClient();
+	return c ? c->getRecording().get().size() : 0;
+}
+
+// js copies the log in here before calling owop_api_replay
+static std::vector<u8> replayBuf;
+
+EMSCRIPTEN_KEEPALIVE
+u8 * owop_api_replay_buffer(sz_t size) {
+	replayBuf.resize(size);
+	return replayBuf.data();
+}
+
+EMSCRIPTEN_KEEPALIVE
+bool owop_api_replay(bool realtime) {
+	Client * c = JsApiProxy::getClient();
+	if (!c) {
+		return false;
+	}
+
+	return c->replay(std::move(replayBuf), realtime);
+}
+
+EMSCRIPTEN_KEEPALIVE
+bool owop_api_crowd_bench(u32 cursors, u32 ticks, u32 areasSide, u32 speed, float moveChance, float churn,
+		u32 toolActions, u32 seed, bool realtime) {
+	Client * c = JsApiProxy::getClient();
+	if (!c) {
+		return false;
+	}
+
+	CrowdTrafficGen::Config cfg{cursors, ticks, areasSide, speed, moveChance, churn, toolActions, seed};
+	return c->replay(std::make_unique<CrowdTrafficGen>(cfg), realtime);
+}
+
+static const ClockSync::Stats * getNetStats() {
+	Client * c = JsApiProxy::getClient();
+	return c ? &c->getClockSync().getStats() : nullptr;
+}
+
+EMSCRIPTEN_KEEPALIVE
+double owop_api_get_rtt(void) {
+	auto * st = getNetStats();
+	return st ? st->rtt : 0.0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+double owop_api_get_srtt(void) {
+	auto * st = getNetStats();
+	return st ? st->srtt : 0.0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+double owop_api_get_min_rtt(void) {
+	auto * st = getNetStats();
+	return st ? st->minRtt : 0.0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+double owop_api_get_rtt_jitter(void) {
+	auto * st = getNetStats();
+	return st ? st->jitter : 0.0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+double owop_api_get_clock_offset(void) {
+	auto * st = getNetStats();
+	return st ? st->offset : 0.0;
+}
+
+// the server's clock now, in ms, to line up with its logs. 0 until synced
+EMSCRIPTEN_KEEPALIVE
+double owop_api_get_server_time(void) {
+	Client * c = JsApiProxy::getClient();
+	return c && c->getClockSync().isSynced() ? c->getClockSync().toServerTime(emscripten_get_now()) : 0.0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+bool owop_api_is_clock_synced(void) {
+	Client * c = JsApiProxy::getClient();
+	return c && c->getClockSync().isSynced();
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_ping_samples(void) {
+	auto * st = getNetStats();
+	return st ? st->samples : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_pings_lost(void) {
+	auto * st = getNetStats();
+	return st ? st->lost : 0;
+}
+
+/******
+ * RENDERER API
+ ******/
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_cursors_drawn(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getCursorStats().drawn : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_cursors_culled(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getCursorStats().culled : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_cursors_rewritten(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getCursorStats().rewritten : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_cursor_crowds(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getCursorStats().crowds : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_draw_calls(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getDrawStats().drawCalls : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_chunks_drawn(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getDrawStats().chunks : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_pooled_chunks(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getChunkTexPool().getUsedLayers() : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_pooled_protections(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getChunkTexPool().getUsedProtLayers() : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_instanced_uploads(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getUpdatePlanner().getStats().instanced : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_sub_image_uploads(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getUpdatePlanner().getStats().subImage : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+float owop_api_get_upload_px_cost(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getUpdatePlanner().getPxCost() : 0.f;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void owop_api_set_upload_px_cost(float bytes) {
+	if (Renderer * r = JsApiProxy::getRenderer()) {
+		r->getUpdatePlanner().setPxCost(bytes);
+	}
+}
+
+EMSCRIPTEN_KEEPALIVE
+u8 owop_api_get_chunk_variant(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getChunkVariant() : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+u8 owop_api_get_built_chunk_variants(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getBuiltChunkVariantCount() : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void owop_api_force_chunk_variant(i8 variant) {
+	if (Renderer * r = JsApiProxy::getRenderer()) {
+		r->forceChunkVariant(variant);
+	}
+}
+
+EMSCRIPTEN_KEEPALIVE
+double owop_api_upload_bench(u32 pixels, u32 frames, bool sparse, u8 strategy) {
+	Renderer * r = JsApiProxy::getRenderer();
+	if (!r || strategy > static_cast<u8>(ChunkUpdatePlanner::Strategy::SUB_IMAGE)) {
+		return -1.0;
+	}
+
+	return r->benchChunkUploads(pixels, frames, sparse, static_cast<ChunkUpdatePlanner::Strategy>(strategy));
+}
+
+EMSCRIPTEN_KEEPALIVE
+bool owop_api_render_bench_start(u32 frames, u32 seed, float radius, u32 checksumEvery, bool cursors) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r && r->startRenderBench({frames, seed, radius, checksumEvery, cursors});
+}
+
+EMSCRIPTEN_KEEPALIVE
+bool owop_api_render_bench_running(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r && r->isRenderBenchRunning();
+}
+
+static const RenderBench::Result * getRenderBenchResult() {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r && r->getRenderBenchResult() ? &*r->getRenderBenchResult() : nullptr;
+}
+
+EMSCRIPTEN_KEEPALIVE
+double owop_api_render_bench_stat(u8 which) {
+	auto * res = getRenderBenchResult();
+	if (!res) {
+		return 0.0;
+	}
+
+	switch (which) {
+		case 0: return res->frames;
+		case 1: return res->w;
+		case 2: return res->h;
+		case 3: return res->avgMs;
+		case 4: return res->p50Ms;
+		case 5: return res->p99Ms;
+		case 6: return res->maxMs;
+		case 7: return res->scene;
+		case 8: return res->expectedScene;
+		default: return 0.0;
+	}
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_render_bench_checksums(void) {
+	auto * res = getRenderBenchResult();
+	return res ? res->checksums.size() : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_render_bench_checksum(u32 i) {
+	auto * res = getRenderBenchResult();
+	return res && i < res->checksums.size() ? res->checksums[i] : 0;
+}
+
+#ifdef FRAME_PROFILER
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_prof_frames(void) {
+	return FrameProfiler::get().getFrameCount();
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_prof_phases(void) {
+	return FrameProfiler::P_NUM;
+}
+
+EMSCRIPTEN_KEEPALIVE
+const char * owop_api_prof_phase_name(u8 phase) {
+	return FrameProfiler::getPhaseName(static_cast<FrameProfiler::Phase>(phase));
+}
+
+EMSCRIPTEN_KEEPALIVE
+bool owop_api_prof_has_gpu_timers(void) {
+	return FrameProfiler::get().hasGpuTimers();
+}
+
+EMSCRIPTEN_KEEPALIVE
+float owop_api_prof_percentile(u8 phase, bool gpu, float p) {
+	if (phase >= FrameProfiler::P_NUM) {
+		return -1.f;
+	}
+
+	return FrameProfiler::get().percentile(static_cast<FrameProfiler::Phase>(phase), gpu, p);
+}
+
+EMSCRIPTEN_KEEPALIVE
+float owop_api_prof_frame_ms(u32 age, u8 phase, bool gpu) {
+	auto& fp = FrameProfiler::get();
+	if (age >= fp.getFrameCount() || phase >= FrameProfiler::P_NUM) {
+		return -1.f;
+	}
+
+	const auto& f = fp.getFrame(age);
+	return gpu ? f.gpuMs[phase] : f.cpuMs[phase];
+}
+#endif
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_full_frames(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getFrameCounts().full : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_partial_frames(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getFrameCounts().partial : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_cursor_only_frames(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getFrameCounts().cursorOnly : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+float owop_api_get_render_scale(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getRenderScale() : 1.f;
+}
+
+EMSCRIPTEN_KEEPALIVE
+u32 owop_api_get_render_scale_changes(void) {
+	Renderer * r = JsApiProxy::getRenderer();
+	return r ? r->getRenderScaleChanges() : 0;
+}
+
 /******
  * CAMERA API
  ******/
@@ -20,7 +20,8 @@ enum C : u8 {
 	C_SYSTEM_MESSAGE,
 	C_CHAT_MESSAGE,
 	C_STATS,
-	C_SUBSCRIBED_AREAS
+	C_SUBSCRIBED_AREAS,
+	C_PONG
 
 	/*TELEPORT, // use player data for this?
 	PERMISSIONS,
@@ -32,7 +33,8 @@ enum S : u8 {
 	S_PLAYER_UPDATE,
 	S_DO_TOOL_ACTION,
 	S_GET_USER_BY_UID,
-	S_SUBSCRIBE_AREA
+	S_SUBSCRIBE_AREA,
+	S_PING
 };
 
 // Network tool IDs
@@ -57,6 +59,7 @@ using DActionSyncSeq = u8;
 using DAreaSyncSeq = u8;
 using DPlayerStep = u8;
 using DPlayerTid = u8;
+using DPingSeq = u16;
 
 // uid, username, total rep, rank id, rank name, super user, can self manage
 using UviasUser  = std::tuple<User::Id, std::string, User::Rep, UviasRank::Id, std::string, bool, bool>;
@@ -94,6 +97,8 @@ using CChatMessage      = Packet<net::C_CHAT_MESSAGE,     std::optional<std::tup
 using CStats            = Packet<net::C_STATS,            uvar, uvar>;
 // area seq, areas
 using CSubscribedAreas  = Packet<net::C_SUBSCRIBED_AREAS, net::DAreaSyncSeq, std::vector<std::tuple<net::DAbsUpdAreaPos, net::DAbsUpdAreaPos>>>;
+// ping seq, server time in ms, read as late as possible before sending
+using CPong             = Packet<net::C_PONG,             net::DPingSeq, double>;
 
 // Packet definitions, serverbound
 using SPlayerUpdate  = Packet<net::S_PLAYER_UPDATE,   net::PlayerUpd<net::DAbsWPos>, net::DStateSyncSeq>;
@@ -101,3 +106,5 @@ using SDoToolAction  = Packet<net::S_DO_TOOL_ACTION,  net::ToolAction<net::DAbsW
 using SGetUserByUid  = Packet<net::S_GET_USER_BY_UID, User::Id>;
 // x, y, sub(1)/unsub(0)
 using SSubscribeArea = Packet<net::S_SUBSCRIBE_AREA,  net::DAbsUpdAreaPos, net::DAbsUpdAreaPos, bool>;
+// ping seq, echoed back in CPong
+using SPing          = Packet<net::S_PING,            net::DPingSeq>;
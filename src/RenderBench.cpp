@@ -0,0 +1,175 @@
+#include "RenderBench.hpp"
+
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+
+#include <GLES2/gl2.h>
+
+static constexpr float tau = 6.2831853f;
+
+static double nowMs() {
+	using namespace std::chrono;
+	return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+static u32 fnv1a(u32 hash, const u8 * b, sz_t n) {
+	for (sz_t i = 0; i < n; i++) {
+		hash = (hash ^ b[i]) * 0x01000193;
+	}
+
+	return hash;
+}
+
+static u32 mix(u32 h) {
+	h ^= h >> 16;
+	h *= 0x7FEB352D;
+	h ^= h >> 15;
+	h *= 0x846CA68B;
+	h ^= h >> 16;
+	return h;
+}
+
+RenderBench::RenderBench(Config nCfg)
+: cfg(nCfg),
+  frame(0),
+  frameStart(0.0),
+  lastW(0),
+  lastH(0) {
+	frameMs.reserve(cfg.frames);
+}
+
+const RenderBench::Config& RenderBench::getConfig() const {
+	return cfg;
+}
+
+bool RenderBench::isDone() const {
+	return frame >= cfg.frames;
+}
+
+RenderBench::CamState RenderBench::getCamState(u32 f) const {
+	// a figure eight over the chunk grid, zooming between 0.5 and 4 twice per loop
+	float t = cfg.frames ? static_cast<float>(f) / cfg.frames : 0.f;
+	float r = cfg.radius * ChunkConstants::size;
+	return {
+		r * std::sin(t * tau),
+		r * 0.5f * std::sin(t * tau * 2.f),
+		std::exp2(0.5f + 1.5f * std::sin(t * tau * 2.f))
+	};
+}
+
+RenderBench::CamState RenderBench::getCurrentCamState() const {
+	return getCamState(frame);
+}
+
+u32 RenderBench::sceneChecksum() const {
+	u32 hash = 0x811C9DC5;
+	auto add = [&hash] (i32 v) {
+		hash = fnv1a(hash, reinterpret_cast<const u8 *>(&v), sizeof(v));
+	};
+
+	// rounded, so the last bit of sin() from another libm doesn't count
+	ChunkConstants::Pos lastX = 0;
+	ChunkConstants::Pos lastY = 0;
+	for (u32 f = 0; f < cfg.frames; f++) {
+		CamState cs = getCamState(f);
+		add(std::lround(cs.x * 16.f));
+		add(std::lround(cs.y * 16.f));
+		add(std::lround(cs.zoom * 1024.f));
+
+		auto cx = static_cast<ChunkConstants::Pos>(std::floor(cs.x / ChunkConstants::size));
+		auto cy = static_cast<ChunkConstants::Pos>(std::floor(cs.y / ChunkConstants::size));
+		if (f == 0 || cx != lastX || cy != lastY) {
+			PngImage img(mkChunkImage(cx, cy, cfg.seed));
+			hash = fnv1a(hash, img.getData(), static_cast<sz_t>(ChunkConstants::size) * ChunkConstants::size * 4);
+			lastX = cx;
+			lastY = cy;
+		}
+	}
+
+	add(cfg.checksumEvery);
+	add(cfg.cursors);
+	return hash;
+}
+
+void RenderBench::frameStarted() {
+	frameStart = nowMs();
+}
+
+void RenderBench::frameEnded(i32 w, i32 h) {
+	// reading a pixel makes the gpu finish the frame
+	u8 px[4];
+	glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, px);
+	frameMs.emplace_back(nowMs() - frameStart);
+	lastW = w;
+	lastH = h;
+
+	if (cfg.checksumEvery && frame % cfg.checksumEvery == 0) {
+		readBuf.resize(static_cast<sz_t>(w) * h * 4);
+		glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, readBuf.data());
+
+		checksums.emplace_back(fnv1a(0x811C9DC5, readBuf.data(), readBuf.size()));
+	}
+
+	++frame;
+	if (isDone()) {
+		readBuf = {}; // could be a lot
+	}
+}
+
+RenderBench::Result RenderBench::getResult() const {
+	Result r{static_cast<u32>(frameMs.size()), lastW, lastH, sceneChecksum(),
+			cfg == defaultConfig ? referenceScene : 0, 0.f, 0.f, 0.f, 0.f, checksums};
+	if (frameMs.empty()) {
+		return r;
+	}
+
+	std::vector<float> sorted(frameMs);
+	std::sort(sorted.begin(), sorted.end());
+	auto at = [&sorted] (float p) {
+		return sorted[std::min<sz_t>(p * sorted.size(), sorted.size() - 1)];
+	};
+
+	r.avgMs = std::accumulate(sorted.begin(), sorted.end(), 0.f) / sorted.size();
+	r.p50Ms = at(0.5f);
+	r.p99Ms = at(0.99f);
+	r.maxMs = sorted.back();
+	return r;
+}
+
+PngImage RenderBench::mkChunkImage(ChunkConstants::Pos x, ChunkConstants::Pos y, u32 seed) {
+	constexpr u32 sz = ChunkConstants::size;
+	u32 h = mix(mix(mix(seed) ^ static_cast<u32>(x)) ^ static_cast<u32>(y));
+
+	auto clr = [] (u32 v) {
+		return RGB_u{{static_cast<u8>(v), static_cast<u8>(v >> 8), static_cast<u8>(v >> 16), 255}};
+	};
+
+	PngImage img(sz, sz, clr(h), 4);
+	u32 * px = reinterpret_cast<u32 *>(img.getData());
+
+	// some opaque rects, one translucent, and diagonals to catch flips and offsets
+	for (u32 i = 0; i < 6; i++) {
+		h = mix(h + i);
+		u32 rx = h % sz;
+		u32 ry = (h >> 9) % sz;
+		u32 rw = 1 + (h >> 18) % (sz / 2);
+		u32 rh = 1 + mix(h) % (sz / 2);
+		RGB_u c = clr(mix(h ^ 0xA5A5A5A5));
+		if (i == 5) {
+			c.c.a = 128;
+		}
+
+		for (u32 yy = ry; yy < std::min(ry + rh, sz); yy++) {
+			std::fill(px + yy * sz + rx, px + yy * sz + std::min(rx + rw, sz), c.rgb);
+		}
+	}
+
+	for (u32 i = 0; i < sz; i++) {
+		px[i * sz + i] = 0xFF000000;
+		px[i * sz + (sz - 1 - i) / 2] = 0xFFFFFFFF;
+	}
+
+	return img;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+
+#include "util/explints.hpp"
+#include "util/PngImage.hpp"
+#include "world/ChunkConstants.hpp"
+
+// scripted camera path around 0,0 over generated chunks. frame times include waiting for
+// the gpu, and the frame checksums only depend on the scene, canvas size and gl
+// implementation, so a run in a fixed environment (headless chrome on swiftshader, for
+// example) can be compared against golden checksums from an earlier one. the scene
+// checksum covers the rest: if it changed, so did the frames.
+class RenderBench {
+public:
+	struct Config {
+		u32 frames;
+		u32 seed; // of the chunk contents
+		float radius; // of the path, in chunks
+		u32 checksumEvery; // frames, 0 to skip checksums
+		bool cursors; // they come from the network, so off for deterministic frames
+
+		bool operator==(const Config&) const = default;
+	};
+
+	struct CamState {
+		float x;
+		float y;
+		float zoom;
+	};
+
+	struct Result {
+		u32 frames;
+		i32 w;
+		i32 h;
+		u32 scene;
+		u32 expectedScene; // referenceScene for the default config, else 0
+		float avgMs;
+		float p50Ms;
+		float p99Ms;
+		float maxMs;
+		std::vector<u32> checksums;
+	};
+
+	// what OWOP.renderer.renderBench() runs without options
+	static constexpr Config defaultConfig{600, 1, 1.5f, 30, false};
+	// sceneChecksum() of defaultConfig, test/render_bench checks it. after changing the
+	// path or the chunk generation on purpose, `make test` prints the new one to put here.
+	// golden frame checksums aren't committed, they depend on the gl implementation: record
+	// them with `res = await OWOP.renderer.renderBench()` on the build before the change,
+	// then pass `{golden: res}` on the one after, same browser and canvas size
+	static constexpr u32 referenceScene = 0x422AA284;
+
+private:
+	Config cfg;
+	u32 frame;
+	double frameStart;
+	i32 lastW;
+	i32 lastH;
+	std::vector<float> frameMs;
+	std::vector<u32> checksums;
+	std::vector<u8> readBuf;
+
+public:
+	RenderBench(Config);
+
+	const Config& getConfig() const;
+	bool isDone() const;
+	CamState getCamState(u32 frame) const;
+	CamState getCurrentCamState() const;
+	// the camera path and the chunks under it
+	u32 sceneChecksum() const;
+
+	void frameStarted();
+	// waits for the gpu and reads back the default framebuffer if it's a checksum frame
+	void frameEnded(i32 w, i32 h);
+	Result getResult() const;
+
+	static PngImage mkChunkImage(ChunkConstants::Pos x, ChunkConstants::Pos y, u32 seed);
+};
@@ -6,14 +6,18 @@
 #include <cstdlib>
 #include <cmath>
 #include <optional>
+#include <emscripten.h>
+#include <emscripten/html5.h>
 
 #include "gl/CursorRendererGlState.hpp"
+#include "gl/data/ChunkShader.hpp"
 #include "util/color.hpp"
 #include "util/explints.hpp"
 
 #define GL_GLEXT_PROTOTYPES
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
+#include <GLES3/gl3.h>
 
 #include <glm/ext/vector_float3.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -24,6 +28,7 @@
 #include "JsApiProxy.hpp"
 #include "world/World.hpp"
 #include "Settings.hpp"
+#include "FrameProfiler.hpp"
 
 Renderer::Renderer(World& w)
 : w(w),
@@ -31,9 +36,15 @@ Renderer::Renderer(World& w)
   view(1.0f),
   projection(1.0f),
   lastRenderTime(ctx.getTime()),
+  drawStats{},
+  frameCounts{},
   pendingRenderType(R_UI | R_WORLD),
   contextFailureCount(0),
-  frameNum(0) {
+  forcedChunkVariant(-1),
+  frameNum(0),
+  loadAnimTimer(0),
+  loadAnimTime(-1.f),
+  loopWasPaused(true) {
 	if (!ctx.ok()) {
 		std::printf("[Renderer] ctx.ok() == false\n");
 		Client::setStatus(R"(
@@ -54,6 +65,10 @@ Renderer::Renderer(World& w)
 }
 
 Renderer::~Renderer() {
+	if (loadAnimTimer) {
+		emscripten_clear_timeout(loadAnimTimer);
+	}
+
 	std::printf("[Renderer] Destroyed\n");
 }
 
@@ -70,6 +85,87 @@ const gl::GlContext& Renderer::getGlContext() const {
 	return ctx;
 }
 
+ChunkTexPool& Renderer::getChunkTexPool() {
+	return cTexPool;
+}
+
+ChunkUpdatePlanner& Renderer::getUpdatePlanner() {
+	return cUpdPlanner;
+}
+
+Renderer::DrawStats Renderer::getDrawStats() const {
+	return drawStats;
+}
+
+Renderer::FrameCounts Renderer::getFrameCounts() const {
+	return frameCounts;
+}
+
+CursorRendererGlState::Stats Renderer::getCursorStats() const {
+	return cCursorGl ? cCursorGl->getStats() : CursorRendererGlState::Stats{};
+}
+
+u8 Renderer::getChunkVariant() const {
+	if (forcedChunkVariant >= 0) {
+		return forcedChunkVariant;
+	}
+
+	u8 v = 0;
+	if (Settings::get().showGrid) {
+		v |= ChunkShader::V_GRID;
+	}
+
+	if (Settings::get().invertClrs) {
+		v |= ChunkShader::V_INVERT;
+	}
+
+	// what the shader used to check per fragment: supersample when zoomed out or
+	// not too close to a whole zoom level
+	float z = getLayerZoom();
+	float fz = z - std::floor(z);
+	if (z < 6.f && std::abs(fz - (fz > 0.5f)) * 2.f > 0.01f) {
+		v |= ChunkShader::V_SMOOTH;
+	}
+
+	return v;
+}
+
+void Renderer::forceChunkVariant(i8 variant) {
+	forcedChunkVariant = variant >= 0 && variant < ChunkShader::V_NUM ? variant : -1;
+	invalidateWorldLayer();
+	queueRerender();
+}
+
+u8 Renderer::getBuiltChunkVariantCount() const {
+	return cRendererGl ? cRendererGl->getBuiltVariantCount() : 0;
+}
+
+float Renderer::getRenderScale() const {
+	return worldLayer && worldLayer->ok() ? worldLayer->getScale() : 1.f;
+}
+
+u32 Renderer::getRenderScaleChanges() const {
+	return resCtl.getChanges();
+}
+
+VisibleChunks::Rect Renderer::getVisibleChunkRect() const {
+	return getVisibleChunkRect(getX(), getY(), getZoom());
+}
+
+VisibleChunks::Rect Renderer::getVisibleChunkRect(float x, float y, float z) const {
+	auto s = ctx.getSize();
+
+	float hVpWidth = s.w / 2.f / z;
+	float hVpHeight = s.h / 2.f / z;
+
+	return {
+		static_cast<Chunk::Pos>(std::floor((x - hVpWidth) / Chunk::size)),
+		static_cast<Chunk::Pos>(std::floor((y - hVpHeight) / Chunk::size)),
+		static_cast<Chunk::Pos>(std::floor((x + hVpWidth) / Chunk::size)),
+		static_cast<Chunk::Pos>(std::floor((y + hVpHeight) / Chunk::size))
+	};
+}
+
 bool Renderer::isChunkVisible(Chunk::Pos px, Chunk::Pos py, float extraPxMargin) const {
 	auto s = ctx.getSize();
 
@@ -110,6 +206,7 @@ void Renderer::chunkUnloaded(Chunk * c) {
 		chunksToUpdate.erase(it);
 	}
 
+	invalidateWorldLayer(c->getX(), c->getY());
 	queueRerender();
 }
 
@@ -168,11 +265,175 @@ void Renderer::queueRerenderSt() {
 	}
 }
 
+double Renderer::benchChunkUploads(u32 pixels, u32 frames, bool sparse, ChunkUpdatePlanner::Strategy strat) {
+	if (!ctx.ok() || !cUpdaterGl || frames == 0) {
+		return -1.0;
+	}
+
+	pixels = std::clamp<u32>(pixels, 1, Chunk::size * Chunk::size);
+
+	// own planner so the real stats aren't touched
+	ChunkUpdatePlanner bp;
+	bp.force(strat);
+	bp.setPxCost(cUpdPlanner.getPxCost());
+
+	ChunkGlState st;
+	st.loadEmpty();
+	st.queueSetPixel(0, 0, RGB_u{{0, 0, 0, 0}});
+	st.renderUpdates(*cUpdaterGl, bp, cTexPool, false); // makes the textures
+	st.getPixel(0, 0); // and the cpu copy, sub image uploads need it
+
+	// dense is a square from the corner, sparse is spread over the whole chunk
+	std::vector<ChunkGlState::PxUpdate> px(pixels);
+	u32 side = std::ceil(std::sqrt(static_cast<float>(pixels)));
+	u32 rng = 0x9E3779B9;
+	for (u32 i = 0; i < pixels; i++) {
+		if (sparse) {
+			rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+			px[i].x = rng % Chunk::size;
+			px[i].y = (rng >> 16) % Chunk::size;
+		} else {
+			px[i].x = i % side;
+			px[i].y = i / side;
+		}
+	}
+
+	double start = emscripten_get_now();
+	for (u32 f = 0; f < frames; f++) {
+		u8 v = f;
+		for (auto& p : px) {
+			p.rgba = {{v, v, v, 255}};
+		}
+
+		st.queueSetPixels(px.data(), px.size(), false);
+		st.renderUpdates(*cUpdaterGl, bp, cTexPool, false);
+	}
+
+	// waits for the gpu to get through all of it
+	u8 sink[4];
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, sink);
+	double ms = (emscripten_get_now() - start) / frames;
+
+	auto s = ctx.getSize();
+	glViewport(0, 0, s.w, s.h);
+	glEnable(GL_BLEND);
+	queueRerender();
+
+	std::printf("[Renderer] Upload bench: %u px (%s), %s: %.3f ms/frame\n", pixels, sparse ? "sparse" : "dense",
+			strat == ChunkUpdatePlanner::Strategy::SUB_IMAGE ? "sub image"
+			: strat == ChunkUpdatePlanner::Strategy::INSTANCED ? "instanced" : "auto", ms);
+	return ms;
+}
+
+bool Renderer::startRenderBench(RenderBench::Config cfg) {
+	if (bench || !ctx.ok() || cfg.frames == 0) {
+		return false;
+	}
+
+	auto nb = std::make_unique<RenderBench>(cfg);
+
+	// every chunk the path will show, so nothing has to load while it runs
+	VisibleChunks::Rect rc = getVisibleChunkRect(0.f, 0.f, 1.f);
+	for (u32 f = 0; f < cfg.frames; f++) {
+		auto cs = nb->getCamState(f);
+		auto fr = getVisibleChunkRect(cs.x, cs.y, cs.zoom);
+		rc = {std::min(rc.tlx, fr.tlx), std::min(rc.tly, fr.tly), std::max(rc.brx, fr.brx), std::max(rc.bry, fr.bry)};
+	}
+
+	sz_t n = static_cast<sz_t>(rc.brx - rc.tlx + 1) * (rc.bry - rc.tly + 1);
+	if (n > w.getMaxLoadedChunks()) {
+		std::printf("[Renderer] Bench path needs %zu chunks, over the limit of %zu. Try a smaller radius\n",
+				n, w.getMaxLoadedChunks());
+		return false;
+	}
+
+	benchPrevCam = {getX(), getY(), getZoom()};
+	setMomentum(0.f, 0.f);
+	resCtl.reset(); // checksums are taken at full resolution
+	benchRect = rc;
+	benchResult = std::nullopt;
+	w.pauseChunkLoading(true);
+
+	for (Chunk::Pos y = rc.tly; y <= rc.bry; y++) {
+		for (Chunk::Pos x = rc.tlx; x <= rc.brx; x++) {
+			Chunk& c = w.getOrMkChunk(x, y);
+			c.loadImage(RenderBench::mkChunkImage(x, y, cfg.seed));
+			c.preventUnloading(true);
+		}
+	}
+
+	std::printf("[Renderer] Render bench: %u frames over %zu chunks\n", cfg.frames, n);
+	bench = std::move(nb);
+	queueRerender();
+	return true;
+}
+
+bool Renderer::isRenderBenchRunning() const {
+	return bench != nullptr;
+}
+
+const std::optional<RenderBench::Result>& Renderer::getRenderBenchResult() const {
+	return benchResult;
+}
+
+void Renderer::benchFrameBegin() {
+	auto cs = bench->getCurrentCamState();
+	setZoom(cs.zoom);
+	setPos(cs.x, cs.y);
+	bench->frameStarted();
+	pendingRenderType |= R_WORLD;
+}
+
+void Renderer::benchFrameEnd() {
+	auto s = ctx.getSize();
+	bench->frameEnded(s.w, s.h);
+	if (bench->isDone()) {
+		finishRenderBench();
+	}
+}
+
+void Renderer::finishRenderBench() {
+	benchResult = bench->getResult();
+	bench = nullptr;
+
+	auto& r = *benchResult;
+	std::printf("[Renderer] Render bench done: %u frames at %ix%i, avg %.2f ms, p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+			r.frames, r.w, r.h, r.avgMs, r.p50Ms, r.p99Ms, r.maxMs);
+
+	for (Chunk::Pos y = benchRect.tly; y <= benchRect.bry; y++) {
+		for (Chunk::Pos x = benchRect.tlx; x <= benchRect.brx; x++) {
+			if (Chunk * c = w.getChunk(x, y)) {
+				c->preventUnloading(false);
+			}
+		}
+	}
+
+	// the generated chunks go, the real ones load back
+	w.unloadAllChunks();
+	w.pauseChunkLoading(false);
+	setZoom(benchPrevCam.zoom);
+	setPos(benchPrevCam.x, benchPrevCam.y);
+}
+
 void Renderer::render() {
+	PROF_SCOPE(P_FRAME);
 	float now = ctx.getTime();
 	float dt = now - lastRenderTime;
 
+	// only the webgl2 path has a layer to scale
+	if (!loopWasPaused && !bench && worldLayer && Settings::get().autoRes && resCtl.frame(dt * 1000.f)) {
+		std::printf("[Renderer] Render scale: %.2f\n", resCtl.getScale());
+		queueRerender();
+	}
+
+	loopWasPaused = false;
+
 	u8 nextRender = preRenderUpdates(now, dt);
+	if (bench) {
+		benchFrameBegin(); // after momentum, the path has the camera
+	}
+
 	u8 currentRender = pendingRenderType;
 	pendingRenderType = R_NONE; // functions called while rendering could request re-render
 
@@ -180,6 +441,11 @@ void Renderer::render() {
 		nextRender |= renderWorld(now, dt) ? R_WORLD : R_NONE;
 	}
 
+	if (bench) {
+		benchFrameEnd();
+		nextRender |= R_WORLD;
+	}
+
 	if (currentRender & R_UI) {
 		nextRender |= renderUi(now, dt) ? R_UI : R_NONE;
 	}
@@ -187,6 +453,7 @@ void Renderer::render() {
 	/* wait until the render loop does nothing to pause rendering to avoid frequent start/stopping */
 	if ((currentRender | pendingRenderType | nextRender) == R_NONE) {
 		ctx.pauseRendering();
+		loopWasPaused = true;
 	}
 
 	pendingRenderType |= nextRender;
@@ -194,14 +461,17 @@ void Renderer::render() {
 }
 
 u8 Renderer::preRenderUpdates(float now, float dt) {
+	PROF_SCOPE(P_PRE_RENDER);
 	u8 nextRender = R_NONE;
 
 	nextRender |= applyMomentum(now, dt) ? R_WORLD : R_NONE;
+	nextRender |= w.interpolateCursors() ? R_WORLD : R_NONE;
 
 	return nextRender;
 }
 
 bool Renderer::renderUi(float now, float dt) {
+	PROF_SCOPE(P_UI);
 	w.updateUi();
 	return false;
 }
@@ -211,131 +481,256 @@ bool Renderer::renderWorld(float now, float dt) {
 
 	auto s = ctx.getSize();
 
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
 	++frameNum;
 
 	bool shouldKeepRendering = false;
-	bool showGrid = Settings::get().showGrid;
-	bool invertClrs = Settings::get().invertClrs;
 	RGB_u clr = w.getBackgroundColor();
 	glm::vec3 clrv3{clr.c.r / 255.f, clr.c.g / 255.f, clr.c.b / 255.f};
 
 	float czoom = getZoom();
 	float hVpWidth = s.w / 2.f / czoom;
 	float hVpHeight = s.h / 2.f / czoom;
-	float tlx = std::floor((getX() - hVpWidth) / Chunk::size);
-	float tly = std::floor((getY() - hVpHeight) / Chunk::size);
-	float brx = std::floor((getX() + hVpWidth) / Chunk::size);
-	float bry = std::floor((getY() + hVpHeight) / Chunk::size);
 
 	bool glstActive = false;
-	for (auto ch : chunksToUpdate) {
-		ChunkGlState& cgl = ch->getGlState();
-		glstActive |= cgl.renderUpdates(*cUpdaterGl, glstActive);
+	{
+		PROF_SCOPE(P_CHUNK_UPDATES);
+		for (auto ch : chunksToUpdate) {
+			ChunkGlState& cgl = ch->getGlState();
+			glstActive |= cgl.renderUpdates(*cUpdaterGl, cUpdPlanner, cTexPool, glstActive);
+			w.signalChunkStateChanged(ch); // may have gone from loading to textured
+			invalidateWorldLayer(ch->getX(), ch->getY());
+		}
+
+		chunksToUpdate.clear();
+
+		if (glstActive) {
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glEnable(GL_BLEND);
+		}
 	}
 
-	chunksToUpdate.clear();
+	const VisibleChunks& vis = w.getVisibleChunks();
 
-	if (glstActive) {
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-		glEnable(GL_BLEND);
+	drawStats = {};
+
+	bool anyLoading = false;
+	for (LoadState ls : {LoadState::LOADING, LoadState::ERROR, LoadState::UNLOADED}) {
+		anyLoading |= !vis.get(ls).empty();
 	}
 
-	glViewport(0, 0, s.w, s.h);
-	cRendererGl->use();
+	float animTime = std::floor(now * loadAnimFps) / loadAnimFps;
+
+	WorldLayerGlState::Redraw redraw = WorldLayerGlState::Redraw::FULL;
+	if (worldLayer) {
+		// also after a context reset, the layer is new then
+		worldLayer->setScale(resCtl.getScale());
+		worldLayer->resize(s.w, s.h);
+		if (anyLoading && animTime != loadAnimTime) {
+			for (LoadState ls : {LoadState::LOADING, LoadState::ERROR, LoadState::UNLOADED}) {
+				for (const auto& t : vis.get(ls)) {
+					invalidateWorldLayer(t.x, t.y);
+				}
+			}
+		}
+	}
 
-	TexturedChunkProgram& tcp = cRendererGl->getTexChunkProg();
-	EmptyChunkProgram& ecp = cRendererGl->getEmptyChunkProg();
-	LoadingChunkProgram& lcp = cRendererGl->getLoadChunkProg();
-	LoadState progInUse = LoadState::ERROR;
-
-	// TODO: improve this
-	// RENDER CHUNKS
-	for (; tly <= bry; tly += 1.f) {
-		for (float tlx2 = tlx; tlx2 <= brx; tlx2 += 1.f) {
-			Chunk* c = w.getChunk(tlx2, tly);
-			const ChunkGlState* glst = c != nullptr ? &c->getGlState() : nullptr;
-			LoadState ls = glst != nullptr ? glst->getLoadState() : LoadState::UNLOADED;
-
-			switch (ls) {
-				case LoadState::TEXTURED:
-					if (progInUse != LoadState::TEXTURED) {
-						tcp.use();
-						tcp.setUShowGrid(showGrid);
-						tcp.setUInvertColors(invertClrs);
-						tcp.setUZoom(getZoom());
-						tcp.setUMats(projection, view);
-						tcp.setUBgClr(clrv3);
-						progInUse = LoadState::TEXTURED;
-					}
-
-					glActiveTexture(GL_TEXTURE1);
-					glst->getProtGlTex().use(GL_TEXTURE_2D);
-					glActiveTexture(GL_TEXTURE0);
-					glst->getPixelGlTex().use(GL_TEXTURE_2D);
-
-					tcp.setUOffset({tlx2 * Chunk::size, tly * Chunk::size});
-					glDrawArrays(GL_TRIANGLES, 0, cRendererGl->vertexCount());
-					break;
-
-				case LoadState::EMPTY:
-					if (progInUse != LoadState::EMPTY) {
-						ecp.use();
-						ecp.setUShowGrid(showGrid);
-						ecp.setUInvertColors(invertClrs);
-						ecp.setUZoom(getZoom());
-						ecp.setUMats(projection, view);
-						ecp.setUBgClr(clrv3);
-						progInUse = LoadState::EMPTY;
-					}
-
-					ecp.setUOffset({tlx2 * Chunk::size, tly * Chunk::size});
-					glDrawArrays(GL_TRIANGLES, 0, cRendererGl->vertexCount());
-					break;
-
-				case LoadState::ERROR:
-				case LoadState::UNLOADED:
-				case LoadState::LOADING:
-					if (progInUse != LoadState::LOADING) {
-						lcp.use();
-						lcp.setUShowGrid(showGrid);
-						lcp.setUInvertColors(invertClrs);
-						lcp.setUZoom(getZoom());
-						lcp.setUMats(projection, view);
-						lcp.setUBgClr(clrv3);
-						lcp.setUTime(now);
-						progInUse = LoadState::LOADING;
-					}
-
-					lcp.setUOffset({tlx2 * Chunk::size, tly * Chunk::size});
-					glDrawArrays(GL_TRIANGLES, 0, cRendererGl->vertexCount());
-					shouldKeepRendering = true; // keep rendering animation
-					break;
-
-				default:
-					break;
+	{
+		PROF_SCOPE(P_CHUNK_DRAW);
+		if (worldLayer && worldLayer->ok()) {
+			redraw = worldLayer->begin();
+		} else {
+			glViewport(0, 0, s.w, s.h);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		}
+
+		if (redraw != WorldLayerGlState::Redraw::NONE) {
+			renderBackground(animTime, vis, clrv3);
+			loadAnimTime = animTime;
+			if (cRendererGl->hasInstancing()) {
+				renderChunksInstanced(vis, clrv3);
+			} else {
+				renderChunks(vis, clrv3);
 			}
 		}
+
+		if (worldLayer && worldLayer->ok()) {
+			if (redraw != WorldLayerGlState::Redraw::NONE) {
+				worldLayer->end();
+			}
+
+			worldLayer->blit();
+			glViewport(0, 0, s.w, s.h);
+		}
+	}
+
+	// a timer brings the next animation frame, instead of rendering every frame until then
+	if (anyLoading && !loadAnimTimer) {
+		double ms = (animTime + 1.f / loadAnimFps - now) * 1000.0;
+		loadAnimTimer = emscripten_set_timeout(Renderer::doLoadAnimTick, std::max(ms, 1.0), this);
+	}
+
+	switch (redraw) {
+		case WorldLayerGlState::Redraw::FULL: ++frameCounts.full; break;
+		case WorldLayerGlState::Redraw::PARTIAL: ++frameCounts.partial; break;
+		case WorldLayerGlState::Redraw::NONE: ++frameCounts.cursorOnly; break;
 	}
 
 	// RENDER PLAYERS
 	const auto& cursors = w.getCursors();
-	if (!cursors.empty()) {
+	if (!cursors.empty() && (!bench || bench->getConfig().cursors)) {
+		PROF_SCOPE(P_CURSORS);
 		auto& program = cCursorGl->getProgram();
 		cCursorGl->use();
 		program.setUMats(projection, view);
 		program.setUWorldZoom(getZoom());
 		program.setUDpr(ctx.getDpr());
-		shouldKeepRendering |= cCursorGl->uploadCurData(w.getToolManager(), cursors);
-		glDrawArraysInstancedANGLE(GL_TRIANGLES, 0, 6, cursors.size());
+		shouldKeepRendering |= cCursorGl->uploadCurData(w.getToolManager(), cursors,
+				getX() - hVpWidth, getY() - hVpHeight, getX() + hVpWidth, getY() + hVpHeight,
+				getZoom(), ctx.getDpr(), Settings::get().groupCrowds);
+
+		if (u32 n = cCursorGl->getStats().drawn) {
+			glDrawArraysInstancedANGLE(GL_TRIANGLES, 0, 6, n);
+			++drawStats.drawCalls;
+		}
 	}
 
 	return shouldKeepRendering;
 }
 
+void Renderer::invalidateWorldLayer() {
+	if (worldLayer) {
+		worldLayer->invalidate();
+	}
+}
+
+void Renderer::invalidateWorldLayer(Chunk::Pos x, Chunk::Pos y) {
+	if (!worldLayer) {
+		return;
+	}
+
+	// same mapping as the projection, layer y goes up. 1px of slack for rounding
+	auto s = ctx.getSize();
+	float czoom = getZoom();
+	float sx = (static_cast<float>(x) * Chunk::size - getX()) * czoom + std::floor(s.w / 2.f);
+	float sy = std::floor(s.h / 2.f) - (static_cast<float>(y + 1) * Chunk::size - getY()) * czoom;
+	float sz = Chunk::size * czoom;
+
+	worldLayer->invalidate(std::floor(sx) - 1, std::floor(sy) - 1, std::ceil(sz) + 2, std::ceil(sz) + 2);
+}
+
+float Renderer::getLayerZoom() const {
+	return getZoom() * getRenderScale();
+}
+
+void Renderer::setupChunkProgram(ChunkProgram& p, glm::vec3 bgClr) {
+	p.use();
+	p.setUZoom(getLayerZoom()); // grid lines and patterns are sized in layer pixels
+	p.setUMats(projection, view);
+	p.setUBgClr(bgClr);
+}
+
+void Renderer::renderBackground(float time, const VisibleChunks& vis, glm::vec3 bgClr) {
+	using LoadState = ChunkGlState::LoadState;
+
+	if (vis.size() == 0) {
+		return;
+	}
+
+	const auto& r = vis.getRect();
+	u32 rw = r.brx - r.tlx + 1;
+	u32 rh = r.bry - r.tly + 1;
+
+	loadMaskBuf.assign(static_cast<sz_t>(rw) * rh, 0);
+	for (LoadState ls : {LoadState::LOADING, LoadState::ERROR, LoadState::UNLOADED}) {
+		for (const auto& t : vis.get(ls)) {
+			loadMaskBuf[static_cast<sz_t>(t.y - r.tly) * rw + (t.x - r.tlx)] = 255;
+		}
+	}
+
+	cRendererGl->use();
+	glActiveTexture(GL_TEXTURE0);
+	cRendererGl->uploadLoadMask(rw, rh, loadMaskBuf.data());
+
+	BackgroundChunkProgram& bcp = cRendererGl->getBackgroundProg(getChunkVariant());
+	setupChunkProgram(bcp, bgClr);
+	bcp.setUTime(time);
+	bcp.setUOffset({static_cast<float>(r.tlx) * Chunk::size, static_cast<float>(r.tly) * Chunk::size});
+	bcp.setURectSize({static_cast<float>(rw), static_cast<float>(rh)});
+	glDrawArrays(GL_TRIANGLES, 0, cRendererGl->vertexCount());
+
+	++drawStats.drawCalls;
+	drawStats.chunks += vis.size() - vis.get(LoadState::TEXTURED).size();
+}
+
+void Renderer::renderChunks(const VisibleChunks& vis, glm::vec3 bgClr) {
+	const auto& tiles = vis.get(ChunkGlState::LoadState::TEXTURED);
+	if (tiles.empty()) {
+		return;
+	}
+
+	cRendererGl->use();
+	ownTexChunks.clear();
+	for (const auto& t : tiles) {
+		ownTexChunks.emplace_back(t.c);
+	}
+
+	renderTexturedChunks(ownTexChunks, getChunkVariant(), bgClr);
+	drawStats.drawCalls += tiles.size();
+	drawStats.chunks += tiles.size();
+}
+
+void Renderer::renderChunksInstanced(const VisibleChunks& vis, glm::vec3 bgClr) {
+	u8 variant = getChunkVariant();
+	chunkInstances.clear();
+	ownTexChunks.clear();
+
+	for (const auto& t : vis.get(ChunkGlState::LoadState::TEXTURED)) {
+		if (int layer = t.c->getGlState().getPoolLayer(); layer >= 0) {
+			chunkInstances.push_back({static_cast<float>(t.x) * Chunk::size, static_cast<float>(t.y) * Chunk::size,
+					static_cast<float>(layer), ChunkShader::instStateTextured});
+		} else {
+			ownTexChunks.emplace_back(t.c); // didn't fit in the pool
+		}
+	}
+
+	if (!chunkInstances.empty()) {
+		InstancedChunkProgram& icp = cRendererGl->getInstancedChunkProg(variant);
+		cRendererGl->useInstanced();
+		cRendererGl->uploadInstances(chunkInstances);
+		setupChunkProgram(icp, bgClr);
+
+		glActiveTexture(GL_TEXTURE0);
+		cTexPool.getPixelArray().use(GL_TEXTURE_2D_ARRAY);
+
+		glDrawArraysInstancedANGLE(GL_TRIANGLES, 0, cRendererGl->vertexCount(), chunkInstances.size());
+		++drawStats.drawCalls;
+	}
+
+	if (!ownTexChunks.empty()) {
+		cRendererGl->use();
+		renderTexturedChunks(ownTexChunks, variant, bgClr);
+		drawStats.drawCalls += ownTexChunks.size();
+	}
+
+	drawStats.chunks += chunkInstances.size() + ownTexChunks.size();
+}
+
+void Renderer::renderTexturedChunks(const std::vector<const Chunk *>& chunks, u8 variant, glm::vec3 bgClr) {
+	TexturedChunkProgram& tcp = cRendererGl->getTexChunkProg(variant);
+	setupChunkProgram(tcp, bgClr);
+	glActiveTexture(GL_TEXTURE0);
+
+	for (const Chunk * c : chunks) {
+		c->getGlState().getPixelGlTex().use(GL_TEXTURE_2D);
+
+		tcp.setUOffset({static_cast<float>(c->getX()) * Chunk::size, static_cast<float>(c->getY()) * Chunk::size});
+		glDrawArrays(GL_TRIANGLES, 0, cRendererGl->vertexCount());
+	}
+}
+
 bool Renderer::setupView() {
 	view = glm::translate(glm::mat4(1.0f), glm::vec3(-getX(), -getY(), 0.f));
+	invalidateWorldLayer();
 
 	//view = glm::lookAt(eye, center, up);
 	queueRerender();
@@ -358,6 +753,7 @@ bool Renderer::setupProjection() {
 			0.5f, 1.5f);
 
 	projection = glm::scale(projection, glm::vec3(1.f, 1.f, -1.f));
+	invalidateWorldLayer();
 
 	//std::puts(glm::to_string(projection).c_str());
 	queueRerender();
@@ -404,10 +800,40 @@ bool Renderer::setupRenderingCallbacks() {
 	});
 
 	skShowGridCh = Settings::get().showGrid.connect([this] (auto) {
+		invalidateWorldLayer();
 		queueRerender();
 	});
 
 	skInvertClrsCh = Settings::get().invertClrs.connect([this] (auto) {
+		invalidateWorldLayer();
+		queueRerender();
+	});
+
+	skGroupCrowdsCh = Settings::get().groupCrowds.connect([this] (auto) {
+		queueRerender();
+	});
+
+	skAutoResCh = Settings::get().autoRes.connect([this] (bool on) {
+		if (!on) {
+			resCtl.reset();
+			queueRerender();
+		}
+	});
+
+	// theme pointers may change when another one loads, so rebuild on both
+	skThemeLoaded = ThemeManager::get().onThemeLoaded.connect([this] (auto&) {
+		if (cCursorGl) {
+			cCursorGl->invalidateTheme();
+		}
+
+		queueRerender();
+	});
+
+	skThemeSwitched = ThemeManager::get().onThemeSwitched.connect([this] (auto&) {
+		if (cCursorGl) {
+			cCursorGl->invalidateTheme();
+		}
+
 		queueRerender();
 	});
 
@@ -415,10 +841,19 @@ bool Renderer::setupRenderingCallbacks() {
 }
 
 void Renderer::destroyGlState() {
+	if (bench) {
+		finishRenderBench(); // cut short, its chunks can't stay
+	}
+
 	cRendererGl = std::nullopt;
 	cUpdaterGl = std::nullopt;
 	cCursorGl = std::nullopt;
+	worldLayer = std::nullopt;
+#ifdef FRAME_PROFILER
+	FrameProfiler::get().destroyGl();
+#endif
 	w.unloadAllChunks();
+	cTexPool.destroy();
 }
 
 bool Renderer::resetGlState(bool unloadChunks) {
@@ -427,9 +862,18 @@ bool Renderer::resetGlState(bool unloadChunks) {
 	}
 
 	bool ok = true;
-	cRendererGl = ChunkRendererGlState{};
+	cTexPool.reset(ctx.isWebgl2());
+	cRendererGl = ChunkRendererGlState{cTexPool.ok()};
 	cUpdaterGl = ChunkUpdaterGlState{};
 	cCursorGl = CursorRendererGlState{};
+	worldLayer = std::nullopt;
+	if (ctx.isWebgl2()) {
+		worldLayer.emplace();
+	}
+
+#ifdef FRAME_PROFILER
+	FrameProfiler::get().resetGl(ctx.isWebgl2() && ctx.enableExtension("EXT_disjoint_timer_query_webgl2"));
+#endif
 
 	ok &= cRendererGl->ok();
 	ok &= cUpdaterGl->ok();
@@ -478,6 +922,12 @@ void Renderer::doDelayedGlReset(void * r) {
 	static_cast<Renderer *>(r)->delayedGlReset();
 }
 
+void Renderer::doLoadAnimTick(void * r) {
+	Renderer * self = static_cast<Renderer *>(r);
+	self->loadAnimTimer = 0;
+	self->queueRerender();
+}
+
 double Renderer::getScreenDpr() const {
 	return ctx.getDpr();
 }
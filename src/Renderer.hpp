@@ -4,24 +4,49 @@
 #include <vector>
 #include <string_view>
 #include <optional>
+#include <memory>
 
 #include <glm/ext/matrix_float4x4.hpp>
+#include <glm/vec3.hpp>
 
 #include "Settings.hpp"
+#include "ThemeManager.hpp"
 #include "util/emsc/gl/WebGlContext.hpp"
 #include "util/explints.hpp"
 #include "util/NonCopyable.hpp"
 
 #include "Camera.hpp"
+#include "RenderBench.hpp"
+#include "ResolutionController.hpp"
 #include "world/Chunk.hpp"
+#include "world/VisibleChunks.hpp"
 #include "gl/ChunkRendererGlState.hpp"
+#include "gl/ChunkTexPool.hpp"
+#include "gl/ChunkUpdatePlanner.hpp"
 #include "gl/ChunkUpdaterGlState.hpp"
 #include "gl/CursorRendererGlState.hpp"
+#include "gl/WorldLayerGlState.hpp"
 
 class World;
 
 class Renderer : public Camera, NonCopyable {
 public:
+	struct DrawStats {
+		u32 drawCalls; // world pass, chunk texture updates not included
+		u32 chunks;
+	};
+
+	// world frames since start, by how much of the chunk layer was redrawn
+	struct FrameCounts {
+		u32 full;
+		u32 partial;
+		u32 cursorOnly; // layer reused as is
+	};
+
+	// the loading animation only advances this often, and doesn't keep the render loop
+	// going in between
+	static constexpr float loadAnimFps = 15.f;
+
 	static constexpr sz_t vramMaxLimit = 512 * 1000 * 1000; // 512 MB
 	static constexpr sz_t maxLoadedChunks = vramMaxLimit / (
 			Chunk::size * Chunk::size * Chunk::pxTexNumChannels
@@ -36,19 +61,41 @@ private:
 
 	World& w;
 	gl::WebGlContext ctx;
+	ChunkTexPool cTexPool;
+	ChunkUpdatePlanner cUpdPlanner;
 	std::optional<ChunkRendererGlState> cRendererGl;
 	std::optional<ChunkUpdaterGlState> cUpdaterGl;
 	std::optional<CursorRendererGlState> cCursorGl;
+	std::optional<WorldLayerGlState> worldLayer;
 	glm::mat4 view; // view matrix
 	glm::mat4 projection;
 	decltype(Settings::showGrid)::SlotKey skShowGridCh;
 	decltype(Settings::invertClrs)::SlotKey skInvertClrsCh;
+	decltype(Settings::groupCrowds)::SlotKey skGroupCrowdsCh;
+	decltype(Settings::autoRes)::SlotKey skAutoResCh;
+	decltype(ThemeManager::onThemeLoaded)::SlotKey skThemeLoaded;
+	decltype(ThemeManager::onThemeSwitched)::SlotKey skThemeSwitched;
 	float lastRenderTime;
+	DrawStats drawStats;
+	FrameCounts frameCounts;
 	u8 pendingRenderType;
 	u8 contextFailureCount;
+	i8 forcedChunkVariant; // -1 picks it from the settings and zoom
 	u16 frameNum;
+	long loadAnimTimer;
+	float loadAnimTime; // of the last drawn animation frame
+	bool loopWasPaused; // the next frame interval would include the idle time
+	ResolutionController resCtl;
 
 	std::vector<Chunk *> chunksToUpdate;
+	std::vector<u8> loadMaskBuf;
+	std::vector<ChunkRendererGlState::Instance> chunkInstances; // reused every frame
+	std::vector<const Chunk *> ownTexChunks;
+
+	std::unique_ptr<RenderBench> bench;
+	std::optional<RenderBench::Result> benchResult;
+	RenderBench::CamState benchPrevCam;
+	VisibleChunks::Rect benchRect;
 
 public:
 	Renderer(World&);
@@ -56,7 +103,22 @@ public:
 
 	sz_t getMaxVisibleChunks() const;
 	const gl::GlContext& getGlContext() const;
-
+	ChunkTexPool& getChunkTexPool();
+	ChunkUpdatePlanner& getUpdatePlanner();
+	DrawStats getDrawStats() const; // of the last rendered frame
+	FrameCounts getFrameCounts() const;
+	CursorRendererGlState::Stats getCursorStats() const; // of the last rendered frame
+	// ChunkShader::Variant mask the chunks are drawn with right now
+	u8 getChunkVariant() const;
+	// -1 goes back to automatic, for comparing variants in benchmarks
+	void forceChunkVariant(i8 variant);
+	u8 getBuiltChunkVariantCount() const;
+	// of the chunk layer, 1 unless automatic resolution lowered it
+	float getRenderScale() const;
+	u32 getRenderScaleChanges() const;
+
+	VisibleChunks::Rect getVisibleChunkRect() const;
+	VisibleChunks::Rect getVisibleChunkRect(float x, float y, float z) const;
 	bool isChunkVisible(Chunk::Pos x, Chunk::Pos y, float extraPxMargin = 0.f) const;
 	bool isChunkVisible(const Chunk&, float extraPxMargin = 0.f) const;
 	void chunkToUpdate(Chunk *);
@@ -66,6 +128,14 @@ public:
 	static void queueUiUpdateSt();
 	static void queueRerenderSt();
 
+	// ms per frame to upload n pixels to a scratch chunk with the given strategy, -1 on error
+	double benchChunkUploads(u32 pixels, u32 frames, bool sparse, ChunkUpdatePlanner::Strategy);
+	// fills the path with generated chunks and renders one bench frame per animation frame,
+	// the world reloads when it ends
+	bool startRenderBench(RenderBench::Config);
+	bool isRenderBenchRunning() const;
+	const std::optional<RenderBench::Result>& getRenderBenchResult() const;
+
 	double getScreenDpr() const override;
 	void getScreenSize(double *w, double *h) const override;
 	void setPos(float, float) override;
@@ -77,9 +147,23 @@ public:
 private:
 	void recalculateCursorPosition() const override;
 
+	void benchFrameBegin();
+	void benchFrameEnd();
+	void finishRenderBench();
+
 	void render();
 	u8 preRenderUpdates(float now, float dt);
 	bool renderWorld(float now, float dt);
+	void invalidateWorldLayer();
+	void invalidateWorldLayer(Chunk::Pos x, Chunk::Pos y);
+	float getLayerZoom() const; // layer px per world px
+	void setupChunkProgram(ChunkProgram&, glm::vec3 bgClr);
+	// empty and loading chunks in one pass, under the textured ones
+	void renderBackground(float time, const VisibleChunks&, glm::vec3 bgClr);
+	void renderChunks(const VisibleChunks&, glm::vec3 bgClr);
+	void renderChunksInstanced(const VisibleChunks&, glm::vec3 bgClr);
+	// chunks with their own textures
+	void renderTexturedChunks(const std::vector<const Chunk *>&, u8 variant, glm::vec3 bgClr);
 	bool renderUi(float now, float dt);
 
 	bool setupView();
@@ -95,4 +179,5 @@ private:
 
 	static void doRender(void *);
 	static void doDelayedGlReset(void *);
+	static void doLoadAnimTick(void *);
 };
@@ -0,0 +1,85 @@
+#include "ResolutionController.hpp"
+
+#include <algorithm>
+
+ResolutionController::ResolutionController()
+: samples{},
+  numSamples(0),
+  refreshMs(1000.f / 60.f),
+  goodFrames(0),
+  upWait(minUpWait),
+  framesSinceUp(0),
+  changes(0),
+  step(0) { }
+
+bool ResolutionController::frame(float ms) {
+	if (ms <= 0.f || ms > 250.f) {
+		return false; // hitches and background tabs say nothing about the gpu
+	}
+
+	// creeps back up slowly in case the refresh rate went down (moved to another screen)
+	refreshMs = std::min(refreshMs * 1.0005f, std::max(ms, 4.f));
+
+	samples[numSamples++] = ms;
+	if (numSamples < window) {
+		return false;
+	}
+
+	numSamples = 0;
+	framesSinceUp += window;
+
+	auto mid = samples.begin() + window / 2;
+	std::nth_element(samples.begin(), mid, samples.end());
+	float median = *mid;
+
+	if (median > refreshMs * 1.35f) {
+		goodFrames = 0;
+		if (step + 1u >= steps.size()) {
+			return false;
+		}
+
+		// right after a step up, that one was too much
+		upWait = framesSinceUp <= window * 2 ? std::min(upWait * 2, maxUpWait) : minUpWait;
+		++step;
+		++changes;
+		return true;
+	}
+
+	if (median > refreshMs * 1.1f) {
+		goodFrames = 0; // holding up, but no headroom
+		return false;
+	}
+
+	goodFrames += window;
+	if (step == 0 || goodFrames < upWait) {
+		return false;
+	}
+
+	goodFrames = 0;
+	framesSinceUp = 0;
+	--step;
+	++changes;
+	return true;
+}
+
+void ResolutionController::reset() {
+	numSamples = 0;
+	goodFrames = 0;
+	upWait = minUpWait;
+	if (step != 0) {
+		step = 0;
+		++changes;
+	}
+}
+
+float ResolutionController::getScale() const {
+	return steps[step];
+}
+
+float ResolutionController::getRefreshMs() const {
+	return refreshMs;
+}
+
+u32 ResolutionController::getChanges() const {
+	return changes;
+}
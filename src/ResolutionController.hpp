@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+
+#include "util/explints.hpp"
+
+// picks the render scale of the world layer from the intervals between frames. steps down
+// when they're noticeably longer than the display refresh interval, and back up after a
+// stretch of good frames. a step up that goes right back down doubles the wait before
+// the next try, so a borderline gpu doesn't flip flop every few seconds.
+class ResolutionController {
+public:
+	static constexpr std::array<float, 4> steps{1.f, 0.8f, 0.66f, 0.5f};
+	static constexpr sz_t window = 30; // frames per decision
+	static constexpr u32 minUpWait = 120; // good frames before trying a step up
+	static constexpr u32 maxUpWait = 3840;
+
+private:
+	std::array<float, window> samples;
+	sz_t numSamples;
+	float refreshMs; // estimate, the shortest interval seen lately
+	u32 goodFrames;
+	u32 upWait;
+	u32 framesSinceUp;
+	u32 changes;
+	u8 step;
+
+public:
+	ResolutionController();
+
+	// ms since the previous frame, only for frames rendered back to back. returns true
+	// if the scale changed
+	bool frame(float intervalMs);
+	void reset(); // back to full resolution
+
+	float getScale() const;
+	float getRefreshMs() const;
+	u32 getChanges() const;
+};
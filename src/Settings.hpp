@@ -45,7 +45,12 @@ struct Settings {
 	Param<bool> invertClrs{false};
 	Param<bool> showProtectionZones{true};
 	Param<bool> hideAllPlayers{false};
+	Param<bool> groupCrowds{true};
 	Param<bool> nativeRes{true};
+	Param<bool> autoRes{false}; // lowers the world resolution when frames take too long
+
+	// network
+	Param<bool> clockSync{false}; // pings the server to measure latency, it has to answer S_PING
 
 	// audio
 	Param<bool> enableAudio{true};
@@ -281,6 +281,7 @@ Async<bool> ThemeManager::switchTheme(std::string_view key) {
 
 	std::string_view prop{"data-theme"};
 	eui_root_attr_set(prop.data(), prop.size(), currentTheme->keyName.c_str(), currentTheme->keyName.size());
+	onThemeSwitched(*currentTheme);
 
 	co_return true;
 }
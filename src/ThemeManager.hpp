@@ -97,6 +97,7 @@ public:
 
 	Signal<void(ThemeManager&)> onThemeListChanged;
 	Signal<void(Theme&)> onThemeLoaded;
+	Signal<void(Theme&)> onThemeSwitched;
 
 private:
 	Async<> loadThemeList();
@@ -1,24 +1,33 @@
 #include "ChunkGlState.hpp"
 
 #include <cstdio>
+#include <algorithm>
 
 #include "util/gl/Framebuffer.hpp"
 
 #define GL_GLEXT_PROTOTYPES
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
+#include <GLES3/gl3.h>
 
 using LoadState = ChunkGlState::LoadState;
 
 ChunkGlState::ChunkGlState()
-: pixelTex(nullptr),
+: layer(),
+  protLayer(),
+  pixelTex(nullptr),
   protTex(nullptr),
-  ls(LoadState::LOADING) { }
+  ls(LoadState::LOADING),
+  pxTexChannels(4),
+  protection(false) { }
 
 bool ChunkGlState::loading() {
 	ls = LoadState::LOADING;
+	layer = {};
+	protLayer = {};
 	pixelTex = nullptr;
 	protTex = nullptr;
+	protection = false;
 	textureCache.freeMem();
 	return true;
 }
@@ -28,7 +37,7 @@ bool ChunkGlState::loadEmpty() {
 	return true;
 }
 
-bool ChunkGlState::loadTextures(PngImage&& pixelData, const ChunkConstants::ProtTexture& protData) {
+bool ChunkGlState::loadTextures(ChunkTexPool& pool, PngImage&& pixelData, const ChunkConstants::ProtTexture& protData) {
 	const u8 * pxDataPtr = pixelData.getData();
 
 	if (!(pixelData.getWidth() == ChunkConstants::size
@@ -47,6 +56,23 @@ bool ChunkGlState::loadTextures(PngImage&& pixelData, const ChunkConstants::Prot
 		// shouldn't happen, loaded image is converted
 	}
 
+	if (std::any_of(protData.begin(), protData.end(), [] (auto gid) { return gid != 0; })) {
+		loadProtection(pool, reinterpret_cast<const u8 *>(protData.data()));
+	} else {
+		protection = false;
+		protLayer = {};
+		protTex = nullptr;
+	}
+
+	// the arrays are rgba only
+	if (pixelData.getChannels() == 4 && (layer || (layer = pool.alloc()))) {
+		pool.upload(layer.get(), pixelData.getData());
+		pxTexChannels = 4;
+		ls = LoadState::TEXTURED;
+		return true;
+	}
+
+	layer = {};
 	GLint fmt = pixelData.getChannels() == 4 ? GL_RGBA : GL_RGB;
 
 	initAndUsePixelTex();
@@ -54,11 +80,7 @@ bool ChunkGlState::loadTextures(PngImage&& pixelData, const ChunkConstants::Prot
 			ChunkConstants::size, ChunkConstants::size,
 			0, fmt, GL_UNSIGNED_BYTE, pixelData.getData());
 
-	initAndUseProtTex();
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
-			ChunkConstants::pc, ChunkConstants::pc,
-			0, GL_RGBA, GL_UNSIGNED_BYTE, protData.data());
-
+	pxTexChannels = pixelData.getChannels();
 	// makes little sense since it's more likely that the cache won't be needed
 	// textureCache = std::move(pixelData);
 	ls = LoadState::TEXTURED;
@@ -97,6 +119,28 @@ void ChunkGlState::queueSetPixelWithBlending(u16 x, u16 y, RGB_u rgba) {
 	pendingPxUpdates.emplace_back(PxUpdate{x, y, textureCache.getPixel(x, y)});
 }
 
+void ChunkGlState::queueSetPixels(const PxUpdate * px, sz_t n, bool alphaBlending) {
+	if (alphaBlending) {
+		for (sz_t i = 0; i < n; i++) {
+			if (px[i].rgba.c.a != 255) {
+				queueSetPixelWithBlending(px[i].x, px[i].y, px[i].rgba);
+			} else {
+				queueSetPixel(px[i].x, px[i].y, px[i].rgba);
+			}
+		}
+
+		return;
+	}
+
+	pendingPxUpdates.insert(pendingPxUpdates.end(), px, px + n);
+
+	if (textureCache.getData()) {
+		for (sz_t i = 0; i < n; i++) {
+			textureCache.setPixel(px[i].x, px[i].y, px[i].rgba);
+		}
+	}
+}
+
 void ChunkGlState::queueSetProtectionGid(u16 x, u16 y, ChunkConstants::ProtGid gid) {
 	pendingProtUpdates.emplace_back(ProtUpdate{x, y, gid});
 }
@@ -109,6 +153,10 @@ const gl::Texture& ChunkGlState::getProtGlTex() const {
 	return protTex;
 }
 
+int ChunkGlState::getPoolLayer() const {
+	return layer ? layer.get() : -1;
+}
+
 bool ChunkGlState::freeMemory() {
 	sz_t pxVecCap = pendingPxUpdates.capacity();
 	sz_t protVecCap = pendingProtUpdates.capacity();
@@ -129,7 +177,7 @@ bool ChunkGlState::freeMemory() {
 	return false;
 }
 
-bool ChunkGlState::renderUpdates(ChunkUpdaterGlState& glst, bool glstActive) {
+bool ChunkGlState::renderUpdates(ChunkUpdaterGlState& glst, ChunkUpdatePlanner& planner, ChunkTexPool& pool, bool glstActive) {
 	if (!pendingPxUpdates.empty() || !pendingProtUpdates.empty()) {
 		switch (ls) {
 			case LoadState::ERROR:
@@ -145,7 +193,7 @@ bool ChunkGlState::renderUpdates(ChunkUpdaterGlState& glst, bool glstActive) {
 
 			case LoadState::EMPTY:
 				// Init textures to apply the updates
-				loadEmptyTextures();
+				loadEmptyTextures(pool);
 				break;
 
 			default:
@@ -161,19 +209,38 @@ bool ChunkGlState::renderUpdates(ChunkUpdaterGlState& glst, bool glstActive) {
 	}
 
 	if (!pendingPxUpdates.empty()) {
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pixelTex.get(), 0);
-//		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-//			std::printf("Framebuffer not complete\n");
-//		}
-
-		glViewport(0, 0, ChunkConstants::size, ChunkConstants::size);
-		glst.uploadPxData(pendingPxUpdates);
-		glDrawArraysInstancedANGLE(GL_TRIANGLES, 0, 6, pendingPxUpdates.size());
+		// the cache already has the pending updates applied
+		bool cacheOk = textureCache.getData() && textureCache.getChannels() == pxTexChannels;
+		auto plan = planner.plan(pendingPxUpdates, cacheOk, pxTexChannels);
+
+		if (plan.s == ChunkUpdatePlanner::Strategy::SUB_IMAGE) {
+			uploadCacheRows(pool, plan.y0, plan.y1);
+		} else {
+			attachPixelTex(GL_FRAMEBUFFER);
+//			if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+//				std::printf("Framebuffer not complete\n");
+//			}
+
+			glViewport(0, 0, ChunkConstants::size, ChunkConstants::size);
+			glst.uploadPxData(pendingPxUpdates);
+			glDrawArraysInstancedANGLE(GL_TRIANGLES, 0, 6, pendingPxUpdates.size());
+		}
+
+		planner.applied(plan, pendingPxUpdates.size(), pxTexChannels);
 		pendingPxUpdates.clear();
 	}
 
+	if (!protection && std::any_of(pendingProtUpdates.begin(), pendingProtUpdates.end(),
+			[] (const ProtUpdate& u) { return u.gid != 0; })) {
+		loadProtection(pool, nullptr);
+	}
+
+	if (!protection) {
+		pendingProtUpdates.clear(); // unprotecting unprotected cells
+	}
+
 	if (!pendingProtUpdates.empty()) {
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, protTex.get(), 0);
+		attachProtTex(GL_FRAMEBUFFER);
 		glViewport(0, 0, ChunkConstants::pc, ChunkConstants::pc);
 		glst.uploadProtData(pendingProtUpdates);
 		glDrawArraysInstancedANGLE(GL_TRIANGLES, 0, 6, pendingProtUpdates.size());
@@ -215,18 +282,43 @@ RGB_u ChunkGlState::getPixel(u16 x, u16 y) const {
 	return textureCache.getPixel(x, y);
 }
 
-void ChunkGlState::loadEmptyTextures() {
+void ChunkGlState::loadEmptyTextures(ChunkTexPool& pool) {
+	pxTexChannels = 4;
+	protection = false;
+	protLayer = {};
+	protTex = nullptr;
+	if (layer || (layer = pool.alloc())) {
+		pool.clear(layer.get());
+		ls = LoadState::TEXTURED;
+		return;
+	}
+
 	initAndUsePixelTex();
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
 			ChunkConstants::size, ChunkConstants::size,
 			0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
 
+	ls = LoadState::TEXTURED;
+}
+
+void ChunkGlState::loadProtection(ChunkTexPool& pool, const u8 * rgbaProt) {
+	protection = true;
+	if (protLayer || (protLayer = pool.allocProt())) {
+		protTex = nullptr;
+		if (rgbaProt) {
+			pool.uploadProt(protLayer.get(), rgbaProt);
+		} else {
+			pool.clearProt(protLayer.get());
+		}
+
+		return;
+	}
+
+	// webgl zero fills null uploads
 	initAndUseProtTex();
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
 			ChunkConstants::pc, ChunkConstants::pc,
-			0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-
-	ls = LoadState::TEXTURED;
+			0, GL_RGBA, GL_UNSIGNED_BYTE, rgbaProt);
 }
 
 void ChunkGlState::readTexToCache() const {
@@ -239,7 +331,7 @@ void ChunkGlState::readTexToCache() const {
 	if (ls == LoadState::TEXTURED) {
 		gl::Framebuffer fb; // this is probably really bad. figure out some way to get a long lived framebuffer here
 		fb.use(GL_FRAMEBUFFER);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pixelTex.get(), 0);
+		attachPixelTex(GL_FRAMEBUFFER);
 		glReadPixels(0, 0, ChunkConstants::size, ChunkConstants::size, fmt, GL_UNSIGNED_BYTE, static_cast<void *>(textureCache.getData()));
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	}
@@ -249,3 +341,32 @@ void ChunkGlState::readTexToCache() const {
 		textureCache.setPixel(px.x, px.y, px.rgba);
 	}
 }
+
+void ChunkGlState::attachPixelTex(u32 target) const {
+	if (layer) {
+		glFramebufferTextureLayer(target, GL_COLOR_ATTACHMENT0, layer.getPool().getPixelArray().get(), 0, layer.get());
+	} else {
+		glFramebufferTexture2D(target, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pixelTex.get(), 0);
+	}
+}
+
+void ChunkGlState::attachProtTex(u32 target) const {
+	if (protLayer) {
+		glFramebufferTextureLayer(target, GL_COLOR_ATTACHMENT0, protLayer.getPool().getProtArray().get(), 0, protLayer.get());
+	} else {
+		glFramebufferTexture2D(target, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, protTex.get(), 0);
+	}
+}
+
+void ChunkGlState::uploadCacheRows(ChunkTexPool& pool, u16 y0, u16 y1) {
+	const u8 * rows = textureCache.getData() + static_cast<sz_t>(y0) * ChunkConstants::size * pxTexChannels;
+
+	if (layer) {
+		pool.uploadPxRows(layer.get(), y0, y1 - y0, rows);
+		return;
+	}
+
+	GLint fmt = pxTexChannels == 4 ? GL_RGBA : GL_RGB;
+	pixelTex.use(GL_TEXTURE_2D);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y0, ChunkConstants::size, y1 - y0, fmt, GL_UNSIGNED_BYTE, rows);
+}
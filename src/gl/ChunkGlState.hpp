@@ -8,6 +8,8 @@
 
 #include "world/ChunkConstants.hpp"
 #include "gl/ChunkUpdaterGlState.hpp"
+#include "gl/ChunkTexPool.hpp"
+#include "gl/ChunkUpdatePlanner.hpp"
 
 class Renderer;
 
@@ -25,6 +27,9 @@ public:
 	using ProtUpdate = ChunkUpdaterGlState::ProtUpdate;
 
 private:
+	// either layers in the pool, or own textures if they weren't available
+	ChunkTexPool::Layer layer;
+	ChunkTexPool::Layer protLayer;
 	gl::Texture pixelTex;
 	gl::Texture protTex;
 
@@ -34,13 +39,17 @@ private:
 
 	mutable PngImage textureCache;
 	LoadState ls;
+	u8 pxTexChannels; // the cache can only be uploaded if it matches
+	// most chunks have no protections, they get no protection texture or layer until
+	// a cell is protected. stays set if it's unprotected again
+	bool protection;
 
 public:
 	ChunkGlState();
 
 	bool loading();
 	bool loadEmpty();
-	bool loadTextures(PngImage&&, const ChunkConstants::ProtTexture&);
+	bool loadTextures(ChunkTexPool&, PngImage&&, const ChunkConstants::ProtTexture&);
 	bool loadError();
 
 	// Tries to free ram (not vram)
@@ -49,19 +58,27 @@ public:
 	LoadState getLoadState() const;
 	const gl::Texture& getPixelGlTex() const;
 	const gl::Texture& getProtGlTex() const;
+	// layer in the pool's arrays, -1 if it has its own textures
+	int getPoolLayer() const;
 
 	RGB_u getPixel(u16 x, u16 y) const;
 	void queueSetPixel(u16 x, u16 y, RGB_u rgba);
 	void queueSetPixelWithBlending(u16 x, u16 y, RGB_u rgba);
+	void queueSetPixels(const PxUpdate *, sz_t n, bool alphaBlending);
 	void queueSetProtectionGid(u16 x, u16 y, ChunkConstants::ProtGid gid);
 
 	/* returns true if the gl state is activated, else glstActive */
-	bool renderUpdates(ChunkUpdaterGlState&, bool glstActive);
+	bool renderUpdates(ChunkUpdaterGlState&, ChunkUpdatePlanner&, ChunkTexPool&, bool glstActive);
 
 private:
 	void initAndUsePixelTex();
 	void initAndUseProtTex();
-	void loadEmptyTextures();
+	void loadEmptyTextures(ChunkTexPool&);
+	// rgbaProt can be null, all cells unprotected
+	void loadProtection(ChunkTexPool&, const u8 * rgbaProt);
+	void attachPixelTex(u32 target) const;
+	void attachProtTex(u32 target) const;
+	void uploadCacheRows(ChunkTexPool&, u16 y0, u16 y1);
 
 	void readTexToCache() const;
 };
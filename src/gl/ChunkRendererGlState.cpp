@@ -1,9 +1,18 @@
 #include "gl/ChunkRendererGlState.hpp"
 #include "gl/data/ChunkShader.hpp"
+
+#include <cstdio>
+
+#define GL_GLEXT_PROTOTYPES
 #include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+ChunkRendererGlState::ChunkRendererGlState(bool webgl2)
+: verts(ChunkShader::buffer),
+  builtVariants(0) {
+	getTexChunkProg(0);
+	getBackgroundProg(0);
 
-ChunkRendererGlState::ChunkRendererGlState()
-: verts(ChunkShader::buffer) {
 	vao.use();
 	verts.use();
 
@@ -13,10 +22,40 @@ ChunkRendererGlState::ChunkRendererGlState()
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)(2 * sizeof(float)));
 
 	vao.enableAttribs(ChunkShader::attribs.size());
+
+	loadMask.use(GL_TEXTURE_2D);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+	if (!webgl2) {
+		return;
+	}
+
+	getInstancedChunkProg(0);
+	instancedVao.emplace();
+	instancedVao->use();
+	verts.use();
+
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), nullptr);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)(2 * sizeof(float)));
+
+	instanceBuf.use();
+	// vChunkOffsetA
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Instance), nullptr);
+	// vLayerStateA
+	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Instance), (void *)(2 * sizeof(float)));
+	glVertexAttribDivisorANGLE(2, 1);
+	glVertexAttribDivisorANGLE(3, 1);
+
+	instancedVao->enableAttribs(ChunkShader::instancedAttribs.size());
+	vao.use();
 }
 
 bool ChunkRendererGlState::ok() const {
-	return verts.get() && texturedProg.get() && emptyProg.get() && loadingProg.get() && vao.get();
+	bool instancedOk = !instancedVao || (*instancedProgs[0] && instancedVao->get() && instanceBuf.get());
+	return verts.get() && *texturedProgs[0] && *backgroundProgs[0] && vao.get() && loadMask.get() && instancedOk;
 }
 
 void ChunkRendererGlState::use() {
@@ -27,14 +66,56 @@ std::size_t ChunkRendererGlState::vertexCount() {
 	return ChunkShader::buffer.size() / 4;
 }
 
-TexturedChunkProgram& ChunkRendererGlState::getTexChunkProg() {
-	return texturedProg;
+TexturedChunkProgram& ChunkRendererGlState::getTexChunkProg(u8 variant) {
+	return getVariant(texturedProgs, variant & ChunkShader::texturedVariants);
+}
+
+BackgroundChunkProgram& ChunkRendererGlState::getBackgroundProg(u8 variant) {
+	return getVariant(backgroundProgs, variant & ChunkShader::backgroundVariants);
+}
+
+void ChunkRendererGlState::uploadLoadMask(u32 w, u32 h, const u8 * mask) {
+	loadMask.use(GL_TEXTURE_2D);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // rows can be any width
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, w, h, 0, GL_ALPHA, GL_UNSIGNED_BYTE, mask);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+const gl::Texture& ChunkRendererGlState::getLoadMask() const {
+	return loadMask;
+}
+
+bool ChunkRendererGlState::hasInstancing() const {
+	return instancedVao.has_value();
 }
 
-EmptyChunkProgram& ChunkRendererGlState::getEmptyChunkProg() {
-	return emptyProg;
+void ChunkRendererGlState::useInstanced() {
+	instancedVao->use();
 }
 
-LoadingChunkProgram& ChunkRendererGlState::getLoadChunkProg() {
-	return loadingProg;
+InstancedChunkProgram& ChunkRendererGlState::getInstancedChunkProg(u8 variant) {
+	return getVariant(instancedProgs, variant & ChunkShader::instancedVariants);
+}
+
+void ChunkRendererGlState::uploadInstances(const std::vector<Instance>& inst) {
+	// a few hundred bytes, orphaning is simpler than a ring here
+	instanceBuf.data(inst.size() * sizeof(Instance), inst.data(), GL_STREAM_DRAW);
+}
+
+u8 ChunkRendererGlState::getBuiltVariantCount() const {
+	return builtVariants;
+}
+
+template<typename Prog>
+Prog& ChunkRendererGlState::getVariant(Variants<Prog>& progs, u8 variant) {
+	auto& p = progs[variant];
+	if (!p) {
+		p.emplace(variant);
+		++builtVariants;
+		if (!*p && variant != 0) {
+			std::fprintf(stderr, "[ChunkRendererGlState] Variant %u failed to build, using the base one\n", variant);
+		}
+	}
+
+	return *p || variant == 0 ? *p : *progs[0];
 }
@@ -2,31 +2,73 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <array>
+#include <optional>
+#include <vector>
 
 #include "util/gl/ABuffer.hpp"
 #include "util/gl/VtxArray.hpp"
+#include "util/gl/Texture.hpp"
+#include "util/explints.hpp"
+
+#include "gl/data/ChunkShader.hpp"
 
 #include "gl/program/TexturedChunkProgram.hpp"
-#include "gl/program/EmptyChunkProgram.hpp"
-#include "gl/program/LoadingChunkProgram.hpp"
+#include "gl/program/BackgroundChunkProgram.hpp"
+#include "gl/program/InstancedChunkProgram.hpp"
 
 #include <glm/ext/matrix_float4x4.hpp>
 
 class ChunkRendererGlState {
+public:
+	// world pos of the chunk, layer in the ChunkTexPool, ChunkShader::instState*
+	struct Instance {
+		float x;
+		float y;
+		float layer;
+		float state;
+	};
+
+private:
+	template<typename Prog>
+	using Variants = std::array<std::optional<Prog>, ChunkShader::V_NUM>;
+
+	// indexed by ChunkShader::Variant masks, built the first time they're asked for.
+	// variant 0 is always built, it's the fallback if another one fails to compile
 	gl::ABuffer verts;
-	TexturedChunkProgram texturedProg;
-	EmptyChunkProgram emptyProg;
-	LoadingChunkProgram loadingProg;
+	Variants<TexturedChunkProgram> texturedProgs;
+	Variants<BackgroundChunkProgram> backgroundProgs;
 	gl::VtxArray vao;
+	gl::Texture loadMask;
+
+	// webgl2 only
+	Variants<InstancedChunkProgram> instancedProgs;
+	std::optional<gl::VtxArray> instancedVao;
+	gl::ABuffer instanceBuf;
+	u8 builtVariants;
 
 public:
-	ChunkRendererGlState();
+	ChunkRendererGlState(bool webgl2 = false);
 
 	bool ok() const;
 
 	void use();
-	TexturedChunkProgram& getTexChunkProg();
-	EmptyChunkProgram& getEmptyChunkProg();
-	LoadingChunkProgram& getLoadChunkProg();
+	TexturedChunkProgram& getTexChunkProg(u8 variant);
+	BackgroundChunkProgram& getBackgroundProg(u8 variant);
+	// one byte per chunk of the visible rect, row major. non zero if it's loading
+	void uploadLoadMask(u32 w, u32 h, const u8 * mask);
+	const gl::Texture& getLoadMask() const;
 	std::size_t vertexCount();
+
+	bool hasInstancing() const;
+	void useInstanced();
+	InstancedChunkProgram& getInstancedChunkProg(u8 variant);
+	void uploadInstances(const std::vector<Instance>&);
+
+	// programs compiled so far, of every kind
+	u8 getBuiltVariantCount() const;
+
+private:
+	template<typename Prog>
+	Prog& getVariant(Variants<Prog>&, u8 variant);
 };
@@ -0,0 +1,244 @@
+#include "gl/ChunkTexPool.hpp"
+
+#include <cstdio>
+#include <utility>
+#include <algorithm>
+
+#include <GLES3/gl3.h>
+
+#include "world/ChunkConstants.hpp"
+
+static gl::Texture mkArray(sz_t side, u16 layers) {
+	gl::Texture t;
+	t.use(GL_TEXTURE_2D_ARRAY);
+
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, side, side, layers);
+
+	return t;
+}
+
+ChunkTexPool::Layer::Layer()
+: pool(nullptr),
+  gen(0),
+  idx(0),
+  prot(false) { }
+
+ChunkTexPool::Layer::Layer(ChunkTexPool& p, u32 nGen, u16 nIdx, bool nProt)
+: pool(&p),
+  gen(nGen),
+  idx(nIdx),
+  prot(nProt) { }
+
+ChunkTexPool::Layer::~Layer() {
+	release();
+}
+
+ChunkTexPool::Layer::Layer(Layer&& l)
+: pool(std::exchange(l.pool, nullptr)),
+  gen(l.gen),
+  idx(l.idx),
+  prot(l.prot) { }
+
+ChunkTexPool::Layer& ChunkTexPool::Layer::operator=(Layer&& l) {
+	release();
+	pool = std::exchange(l.pool, nullptr);
+	gen = l.gen;
+	idx = l.idx;
+	prot = l.prot;
+	return *this;
+}
+
+u16 ChunkTexPool::Layer::get() const {
+	return idx;
+}
+
+const ChunkTexPool& ChunkTexPool::Layer::getPool() const {
+	return *pool;
+}
+
+ChunkTexPool::Layer::operator bool() const {
+	return pool != nullptr;
+}
+
+void ChunkTexPool::Layer::release() {
+	if (pool) {
+		pool->free(gen, idx, prot);
+		pool = nullptr;
+	}
+}
+
+ChunkTexPool::ChunkTexPool()
+: px{nullptr, {}, 0, 0},
+  prot{nullptr, {}, 0, 0},
+  fb(nullptr),
+  gen(0) { }
+
+void ChunkTexPool::reset(bool webgl2) {
+	destroy();
+	if (!webgl2) {
+		return;
+	}
+
+	GLint maxArrLayers = 0;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxArrLayers);
+	px.maxLayers = prot.maxLayers = std::clamp<GLint>(maxArrLayers, 0, layerLimit);
+	fb = gl::Framebuffer{};
+
+	if (!grow(px, ChunkConstants::size)) {
+		std::printf("[ChunkTexPool] Couldn't allocate texture arrays, using a texture per chunk\n");
+		destroy();
+	}
+}
+
+void ChunkTexPool::destroy() {
+	for (LayerArray * a : {&px, &prot}) {
+		a->tex = nullptr;
+		a->freeLayers.clear();
+		a->capacity = 0;
+		a->maxLayers = 0;
+	}
+
+	fb = nullptr;
+	++gen; // layers still out there won't come back
+}
+
+bool ChunkTexPool::ok() const {
+	return px.capacity != 0;
+}
+
+ChunkTexPool::Layer ChunkTexPool::alloc() {
+	return alloc(px, false);
+}
+
+ChunkTexPool::Layer ChunkTexPool::allocProt() {
+	return alloc(prot, true);
+}
+
+ChunkTexPool::Layer ChunkTexPool::alloc(LayerArray& a, bool isProt) {
+	if (!ok() || (a.freeLayers.empty() && !grow(a, isProt ? ChunkConstants::pc : ChunkConstants::size))) {
+		return {};
+	}
+
+	u16 l = a.freeLayers.back();
+	a.freeLayers.pop_back();
+	return {*this, gen, l, isProt};
+}
+
+void ChunkTexPool::upload(u16 layer, const u8 * rgbaPx) {
+	px.tex.use(GL_TEXTURE_2D_ARRAY);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer,
+			ChunkConstants::size, ChunkConstants::size, 1,
+			GL_RGBA, GL_UNSIGNED_BYTE, rgbaPx);
+}
+
+void ChunkTexPool::uploadProt(u16 protLayer, const u8 * rgbaProt) {
+	prot.tex.use(GL_TEXTURE_2D_ARRAY);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, protLayer,
+			ChunkConstants::pc, ChunkConstants::pc, 1,
+			GL_RGBA, GL_UNSIGNED_BYTE, rgbaProt);
+}
+
+void ChunkTexPool::uploadPxRows(u16 layer, u16 y, u16 h, const u8 * rgbaRows) {
+	px.tex.use(GL_TEXTURE_2D_ARRAY);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, y, layer,
+			ChunkConstants::size, h, 1,
+			GL_RGBA, GL_UNSIGNED_BYTE, rgbaRows);
+}
+
+void ChunkTexPool::clear(u16 layer) {
+	clearLayer(px.tex, layer);
+}
+
+void ChunkTexPool::clearProt(u16 protLayer) {
+	clearLayer(prot.tex, protLayer);
+}
+void ChunkTexPool::clearLayer(const gl::Texture& arr, u16 layer) {
+	// reused layers have the last chunk in them. this can run while the chunk updater
+	// has its framebuffer bound, so put it back after
+	GLint prevFb = 0;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prevFb);
+	GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
+	glDisable(GL_SCISSOR_TEST);
+
+	const GLfloat transparent[4] = {0.f, 0.f, 0.f, 0.f};
+	fb.use(GL_DRAW_FRAMEBUFFER);
+	glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, arr.get(), 0, layer);
+	glClearBufferfv(GL_COLOR, 0, transparent);
+
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, prevFb);
+	if (scissor) {
+		glEnable(GL_SCISSOR_TEST);
+	}
+}
+
+const gl::Texture& ChunkTexPool::getPixelArray() const {
+	return px.tex;
+}
+
+const gl::Texture& ChunkTexPool::getProtArray() const {
+	return prot.tex;
+}
+
+u16 ChunkTexPool::getCapacity() const {
+	return px.capacity;
+}
+
+u16 ChunkTexPool::getUsedLayers() const {
+	return px.capacity - px.freeLayers.size();
+}
+
+u16 ChunkTexPool::getProtCapacity() const {
+	return prot.capacity;
+}
+
+u16 ChunkTexPool::getUsedProtLayers() const {
+	return prot.capacity - prot.freeLayers.size();
+}
+
+bool ChunkTexPool::grow(LayerArray& a, sz_t side) {
+	u16 newCap = std::min<u16>(a.capacity ? a.capacity * 2 : initialLayers, a.maxLayers);
+	if (newCap <= a.capacity) {
+		return false;
+	}
+
+	while (glGetError() != GL_NO_ERROR); // only care about the allocation
+	gl::Texture nArr = mkArray(side, newCap);
+	if (glGetError() == GL_OUT_OF_MEMORY) {
+		std::printf("[ChunkTexPool] Out of vram at %u layers of %zupx\n", newCap, side);
+		a.maxLayers = a.capacity;
+		return false;
+	}
+
+	// arrays can't be resized, copy every old layer over. rare, and all in vram
+	GLint prevFb = 0;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prevFb);
+	fb.use(GL_READ_FRAMEBUFFER);
+	nArr.use(GL_TEXTURE_2D_ARRAY);
+
+	for (u16 l = 0; l < a.capacity; l++) {
+		glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, a.tex.get(), 0, l);
+		glCopyTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, l, 0, 0, side, side);
+	}
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, prevFb);
+	a.tex = std::move(nArr);
+
+	// lowest layers first
+	for (u16 l = newCap; l > a.capacity; l--) {
+		a.freeLayers.emplace_back(l - 1);
+	}
+
+	std::printf("[ChunkTexPool] %u -> %u layers of %zupx\n", a.capacity, newCap, side);
+	a.capacity = newCap;
+	return true;
+}
+
+void ChunkTexPool::free(u32 layerGen, u16 layer, bool isProt) {
+	if (layerGen == gen) {
+		(isProt ? prot : px).freeLayers.emplace_back(layer);
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+
+#include "util/explints.hpp"
+#include "util/gl/Texture.hpp"
+#include "util/gl/Framebuffer.hpp"
+
+// webgl2 only. chunk pixel and protection textures as layers of two texture arrays, so
+// every textured chunk can be drawn by one instanced call. the arrays start small and
+// double (copying the old layers) up to the gpu limit, chunks that don't get a layer
+// keep their own textures. protection layers are handed out separately, only to chunks
+// that have protections, so that array stays as small as they are few.
+class ChunkTexPool {
+public:
+	// gives the layer back when destroyed, layers of a destroyed pool are just forgotten
+	class Layer {
+		ChunkTexPool * pool;
+		u32 gen;
+		u16 idx;
+		bool prot;
+
+	public:
+		Layer();
+		Layer(ChunkTexPool&, u32 nGen, u16 nIdx, bool nProt);
+		~Layer();
+
+		Layer(Layer&&);
+		Layer& operator=(Layer&&);
+		Layer(const Layer&) = delete;
+		Layer& operator=(const Layer&) = delete;
+
+		u16 get() const;
+		const ChunkTexPool& getPool() const;
+		explicit operator bool() const;
+
+	private:
+		void release();
+	};
+
+	static constexpr u16 initialLayers = 16;
+	static constexpr u16 layerLimit = 256; // 256 MB of pixels, same order as Renderer::vramMaxLimit
+
+private:
+	struct LayerArray {
+		gl::Texture tex;
+		std::vector<u16> freeLayers;
+		u16 capacity;
+		u16 maxLayers;
+	};
+
+	LayerArray px;
+	LayerArray prot; // not allocated until a chunk needs it
+	gl::Framebuffer fb; // for copies and clears
+	u32 gen;
+
+public:
+	ChunkTexPool();
+
+	// for a new context, webgl1 disables the pool
+	void reset(bool webgl2);
+	void destroy();
+	bool ok() const;
+
+	// empty if disabled or full
+	Layer alloc();
+	Layer allocProt();
+	void upload(u16 layer, const u8 * rgbaPx);
+	void uploadProt(u16 protLayer, const u8 * rgbaProt);
+	// full width rows of the pixel layer
+	void uploadPxRows(u16 layer, u16 y, u16 h, const u8 * rgbaRows);
+	void clear(u16 layer);
+	void clearProt(u16 protLayer);
+
+	const gl::Texture& getPixelArray() const;
+	const gl::Texture& getProtArray() const;
+	u16 getCapacity() const;
+	u16 getUsedLayers() const;
+	u16 getProtCapacity() const;
+	u16 getUsedProtLayers() const;
+
+private:
+	Layer alloc(LayerArray&, bool isProt);
+	bool grow(LayerArray&, sz_t side);
+	void clearLayer(const gl::Texture& arr, u16 layer);
+	void free(u32 gen, u16 layer, bool isProt);
+};
@@ -0,0 +1,59 @@
+#include "ChunkUpdatePlanner.hpp"
+
+#include <algorithm>
+
+#include "world/ChunkConstants.hpp"
+
+ChunkUpdatePlanner::ChunkUpdatePlanner()
+: stats{},
+  pxCost(defaultPxCost),
+  forced(Strategy::AUTO) { }
+
+ChunkUpdatePlanner::Plan ChunkUpdatePlanner::plan(const std::vector<ChunkUpdaterGlState::PxUpdate>& px, bool haveCache, u8 channels) {
+	if (!haveCache || px.empty() || forced == Strategy::INSTANCED) {
+		return {Strategy::INSTANCED, 0, 0};
+	}
+
+	u16 y0 = ChunkConstants::size;
+	u16 y1 = 0;
+	for (const auto& p : px) {
+		y0 = std::min(y0, p.y);
+		y1 = std::max<u16>(y1, p.y + 1);
+	}
+
+	// whole rows, webgl1 can't upload a sub rect of the cache without copying it
+	float subCost = subImageBaseCost + static_cast<float>(y1 - y0) * ChunkConstants::size * channels;
+	float instCost = static_cast<float>(px.size()) * pxCost;
+
+	if (forced == Strategy::SUB_IMAGE || subCost < instCost) {
+		return {Strategy::SUB_IMAGE, y0, y1};
+	}
+
+	return {Strategy::INSTANCED, 0, 0};
+}
+
+void ChunkUpdatePlanner::applied(const Plan& p, sz_t numPx, u8 channels) {
+	if (p.s == Strategy::SUB_IMAGE) {
+		++stats.subImage;
+		stats.subImageBytes += static_cast<u64>(p.y1 - p.y0) * ChunkConstants::size * channels;
+	} else {
+		++stats.instanced;
+		stats.instancedPx += numPx;
+	}
+}
+
+void ChunkUpdatePlanner::force(Strategy s) {
+	forced = s;
+}
+
+void ChunkUpdatePlanner::setPxCost(float bytes) {
+	pxCost = std::max(bytes, 0.f);
+}
+
+float ChunkUpdatePlanner::getPxCost() const {
+	return pxCost;
+}
+
+const ChunkUpdatePlanner::Stats& ChunkUpdatePlanner::getStats() const {
+	return stats;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+#include "util/explints.hpp"
+#include "gl/ChunkUpdaterGlState.hpp"
+
+// picks how a chunk's pending pixel updates reach its texture. sparse updates are drawn
+// as one instanced quad each, dense ones (fills, pastes, floods) re-upload the dirty rows
+// from the cpu copy of the chunk, if there is one. reading one back would stall, so
+// chunks without it always go instanced.
+class ChunkUpdatePlanner {
+public:
+	enum class Strategy : u8 {
+		AUTO, // only for force()
+		INSTANCED,
+		SUB_IMAGE
+	};
+
+	struct Plan {
+		Strategy s;
+		u16 y0; // dirty rows, sub image only
+		u16 y1; // exclusive
+	};
+
+	struct Stats {
+		u32 instanced; // chunk updates
+		u32 subImage;
+		u64 instancedPx;
+		u64 subImageBytes;
+	};
+
+	// how many uploaded texture bytes one instanced pixel costs, roughly. 8 bytes of
+	// instance data plus a quad through the rasterizer
+	static constexpr float defaultPxCost = 32.f;
+	// texSubImage call overhead, in bytes
+	static constexpr float subImageBaseCost = 4096.f;
+
+private:
+	Stats stats;
+	float pxCost;
+	Strategy forced;
+
+public:
+	ChunkUpdatePlanner();
+
+	Plan plan(const std::vector<ChunkUpdaterGlState::PxUpdate>&, bool haveCache, u8 channels);
+	void applied(const Plan&, sz_t numPx, u8 channels);
+
+	void force(Strategy);
+	void setPxCost(float bytes);
+	float getPxCost() const;
+	const Stats& getStats() const;
+};
@@ -3,13 +3,18 @@
 #include "ThemeManager.hpp"
 #include "gl/data/CursorShader.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <cstring>
 #include <memory>
 
 #include "util/explints.hpp"
 #include "util/gl/Texture.hpp"
 #include "util/misc.hpp"
-#include "world/Cursor.hpp"
+#include "tools/ToolManager.hpp"
+#include "world/CursorStore.hpp"
 
 #define GL_GLEXT_PROTOTYPES
 #include <GLES2/gl2.h>
@@ -17,23 +22,23 @@
 
 CursorRendererGlState::CursorRendererGlState()
 : verts(CursorShader::buffer),
-  fxToolAtlas(nullptr) {
+  fxToolAtlas(nullptr),
+  toolLut{},
+  stats{},
+  currentBuf(0),
+  themeReady(false) {
+	for (InstanceBuf& ib : instBufs) {
+		ib.capacity = 0;
+		ib.dirtyBegin = 0;
+		ib.dirtyEnd = 0;
+	}
+
 	vao.use();
 	verts.use();
 
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr); // vPosA
 
-	cursorData.use();
-
-	constexpr auto offset = [] (std::size_t s) {
-		return reinterpret_cast<void*>(s);
-	};
-
-	constexpr sz_t stride = 8 * sizeof(float);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, offset(0)); // vCamOffsetA
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, offset(2 * sizeof(float))); // vAtlasToolTexPosA
-	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, offset(4 * sizeof(float))); // vAtlasToolTexSizeA
-	glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, stride, offset(6 * sizeof(float))); // vAtlasToolTexHotspotA
+	pointInstanceAttribs();
 	glVertexAttribDivisorANGLE(1, 1);
 	glVertexAttribDivisorANGLE(2, 1);
 	glVertexAttribDivisorANGLE(3, 1);
@@ -46,7 +51,12 @@ CursorRendererGlState::CursorRendererGlState()
 }
 
 bool CursorRendererGlState::ok() const {
-	return verts.get() && cursorData.get() && program.get() && vao.get();
+	bool buffersOk = true;
+	for (const InstanceBuf& ib : instBufs) {
+		buffersOk &= ib.buf.get() != 0;
+	}
+
+	return verts.get() && buffersOk && program.get() && vao.get();
 }
 
 void CursorRendererGlState::use() {
@@ -58,11 +68,9 @@ void CursorRendererGlState::use() {
 	}
 }
 
-bool CursorRendererGlState::uploadCurData(ToolManager& tm, const std::vector<Cursor>& cursors) {
-	auto [buf, sz] = get_char_buf(cursors.size() * sizeof(float) * 8);
-	float* flbuf = reinterpret_cast<float*>(/*std::assume_aligned<alignof(float)>(*/buf/*)*/);
-	sz_t offs = 0;
-	bool needsRender = false;
+bool CursorRendererGlState::uploadCurData(ToolManager& tm, const CursorStore& cursors,
+		float tlx, float tly, float brx, float bry, float worldZoom, float dpr, bool groupCrowds) {
+	stats = {};
 
 	Theme* t = ThemeManager::get().getCurrentTheme();
 	if (!t || t->tools.empty()) {
@@ -71,60 +79,224 @@ bool CursorRendererGlState::uploadCurData(ToolManager& tm, const std::vector<Cur
 		return true;
 	}
 
-	auto& imgAtlas = t->fxToolAtlas;
-	float aw = imgAtlas.getWidth();
-	float ah = imgAtlas.getHeight();
-	if (!fxToolAtlas.get()) {
-		fxToolAtlas = gl::Texture{};
-		glActiveTexture(GL_TEXTURE0);
-		fxToolAtlas.use(GL_TEXTURE_2D);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	if (!themeReady) {
+		loadTheme(tm, *t);
+	}
 
-		assert((imgAtlas.getChannels() == 4 && imgAtlas.getData() != nullptr)); // must be RGBA
+	// same scale as the shader, icons are drawn at most cullMarginPx / toolZoom away from the cursor pos
+	float toolZoom = std::min(worldZoom / dpr, 16.f / dpr);
+	float margin = cullMarginPx / toolZoom;
+	tlx -= margin;
+	tly -= margin;
+	brx += margin;
+	bry += margin;
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, imgAtlas.getWidth(), imgAtlas.getHeight(),
-				0, GL_RGBA, GL_UNSIGNED_BYTE, imgAtlas.getData());
+	visible.clear();
+	cursors.queryRect(tlx, tly, brx, bry, visible);
+	stats.culled = cursors.size() - visible.size();
 
-		program.use();
-		program.setUAtlasSizePx(aw, ah);
+	auto [buf, sz] = get_char_buf(visible.size() * sizeof(float) * instanceFloats);
+	float* flbuf = reinterpret_cast<float*>(/*std::assume_aligned<alignof(float)>(*/buf/*)*/);
+	sz_t offs = 0;
+
+	// zoomed out, cursors sharing a screen cell are drawn as one marker, so the instance
+	// count is bounded by the screen size and not by how many players there are
+	bool grouping = groupCrowds && worldZoom < crowdZoom && visible.size() >= crowdMinCount;
+	float cellSz = crowdCellPx / toolZoom;
+	const auto cellOf = [cellSz] (float x, float y) {
+		return mk_twoi32(std::floor(x / cellSz), std::floor(y / cellSz)).pos;
+	};
+
+	if (grouping) {
+		crowdCells.clear();
+		for (CursorStore::Slot s : visible) {
+			float x = cursors.getDrawX(s);
+			float y = cursors.getDrawY(s);
+			CrowdCell& c = crowdCells[cellOf(x, y)];
+			++c.count;
+			c.sumX += x;
+			c.sumY += y;
+		}
 	}
 
-	auto* defTool = &t->tools[0];
+	for (CursorStore::Slot s : visible) {
+		float x = cursors.getDrawX(s);
+		float y = cursors.getDrawY(s);
+
+		if (grouping) {
+			CrowdCell& c = crowdCells.find(cellOf(x, y))->second;
+			if (c.count >= crowdMinCount) {
+				if (!c.emitted) {
+					c.emitted = true;
+					++stats.crowds;
+					float d = crowdDiscPx + crowdDiscPx * 0.5f * std::log2(static_cast<float>(c.count));
+					flbuf[offs + 0] = c.sumX / c.count;
+					flbuf[offs + 1] = c.sumY / c.count;
+					flbuf[offs + 2] = 0.f;
+					flbuf[offs + 3] = 0.f;
+					flbuf[offs + 4] = -d; // disc, see the shader
+					flbuf[offs + 5] = -d;
+					flbuf[offs + 6] = d / 2.f;
+					flbuf[offs + 7] = d / 2.f;
+					offs += instanceFloats;
+				}
 
-	for (const Cursor& c : cursors) {
-		auto& ts = c.getToolStates();
+				continue;
+			}
+		}
 
-		// all these possible nulls are really ugly
-		auto* tool = tm.getSelectedTool(ts);
-		auto vname = tool ? tool->getToolVisualName(ts) : "";
-		auto vstate = tool ? tool->getToolVisualState(ts) : 0;
-		auto* tinfo = tool ? t->getToolInfo(vname) : defTool;
-		auto& sinfo = tinfo->getState(vstate);
+		auto& ts = cursors.getToolStates(s);
+		const ToolLutEntry& e = toolLut[ts.getSelectedToolNetId()];
+		u8 vstate = e.tool ? e.tool->getToolVisualState(ts) : 0;
+		const ToolVisual& v = toolVisuals[e.first + (vstate < e.count ? vstate : 0)];
 
-		// vCamOffsetA
-		needsRender |= c.getPosLerpTime() != 1.f;
-		flbuf[offs + 0] = c.getSmoothX();
-		flbuf[offs + 1] = c.getSmoothY();
+		// vCamOffsetA, World::interpolateCursors() already ran this frame
+		flbuf[offs + 0] = x;
+		flbuf[offs + 1] = y;
 		// vAtlasToolTexPosA
-		flbuf[offs + 2] = sinfo.fxAtlasX / aw;
-		flbuf[offs + 3] = sinfo.fxAtlasY / ah;
+		flbuf[offs + 2] = v.atlasX;
+		flbuf[offs + 3] = v.atlasY;
 		// vAtlasToolTexSizeA
-		flbuf[offs + 4] = sinfo.fxAtlasW;
-		flbuf[offs + 5] = sinfo.fxAtlasH;
+		flbuf[offs + 4] = v.w;
+		flbuf[offs + 5] = v.h;
 		// vAtlasToolTexHotspotA
-		flbuf[offs + 6] = sinfo.fxHotspotX;
-		flbuf[offs + 7] = sinfo.fxHotspotY;
-		offs += 8;
+		flbuf[offs + 6] = v.hotspotX;
+		flbuf[offs + 7] = v.hotspotY;
+		offs += instanceFloats;
 	}
 
-	cursorData.use();
-	cursorData.data(cursors.size() * sizeof(float) * 8, nullptr, GL_STREAM_DRAW);
-	cursorData.data(cursors.size() * sizeof(float) * 8, static_cast<void*>(flbuf), GL_STREAM_DRAW);
+	u32 n = offs / instanceFloats;
+	u32 oldN = instances.size() / instanceFloats;
+	stats.drawn = n;
+
+	// find what changed since last frame, as one range
+	u32 changedBegin = n;
+	u32 changedEnd = 0;
+	for (u32 i = 0; i < n; i++) {
+		const float* rec = flbuf + i * instanceFloats;
+		if (i >= oldN || std::memcmp(rec, instances.data() + i * instanceFloats, instanceFloats * sizeof(float)) != 0) {
+			changedBegin = std::min(changedBegin, i);
+			changedEnd = i + 1;
+		}
+	}
+
+	instances.assign(flbuf, flbuf + offs);
+
+	if (changedBegin < changedEnd) {
+		for (InstanceBuf& ib : instBufs) {
+			if (ib.dirtyBegin >= ib.dirtyEnd) {
+				ib.dirtyBegin = changedBegin;
+				ib.dirtyEnd = changedEnd;
+			} else {
+				ib.dirtyBegin = std::min(ib.dirtyBegin, changedBegin);
+				ib.dirtyEnd = std::max(ib.dirtyEnd, changedEnd);
+			}
+		}
+	}
+
+	currentBuf = (currentBuf + 1) % ringSize;
+	InstanceBuf& ib = instBufs[currentBuf];
+	constexpr sz_t stride = instanceFloats * sizeof(float);
+
+	if (ib.capacity < n) {
+		ib.capacity = std::max<u32>(n, std::max<u32>(ib.capacity * 2, 64));
+		ib.buf.data(ib.capacity * stride, nullptr, GL_DYNAMIC_DRAW);
+		ib.buf.subData(0, n * stride, instances.data());
+		stats.rewritten = n;
+	} else if (ib.dirtyBegin < ib.dirtyEnd) {
+		u32 end = std::min(ib.dirtyEnd, n);
+		if (ib.dirtyBegin < end) {
+			ib.buf.subData(ib.dirtyBegin * stride, (end - ib.dirtyBegin) * stride,
+					instances.data() + ib.dirtyBegin * instanceFloats);
+			stats.rewritten = end - ib.dirtyBegin;
+		}
+	}
 
-	return needsRender;
+	ib.dirtyBegin = ib.dirtyEnd = 0;
+
+	pointInstanceAttribs();
+
+	return false;
+}
+
+void CursorRendererGlState::invalidateTheme() {
+	themeReady = false;
 }
 
 CursorProgram& CursorRendererGlState::getProgram() {
 	return program;
 }
+
+const CursorRendererGlState::Stats& CursorRendererGlState::getStats() const {
+	return stats;
+}
+
+void CursorRendererGlState::pointInstanceAttribs() {
+	// the vao remembers which buffer each attrib reads from, rebind to the current one
+	instBufs[currentBuf].buf.use();
+
+	constexpr auto offset = [] (std::size_t s) {
+		return reinterpret_cast<void*>(s);
+	};
+
+	constexpr sz_t stride = instanceFloats * sizeof(float);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, offset(0)); // vCamOffsetA
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, offset(2 * sizeof(float))); // vAtlasToolTexPosA
+	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, offset(4 * sizeof(float))); // vAtlasToolTexSizeA
+	glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, stride, offset(6 * sizeof(float))); // vAtlasToolTexHotspotA
+}
+
+void CursorRendererGlState::loadTheme(ToolManager& tm, Theme& t) {
+	auto& imgAtlas = t.fxToolAtlas;
+	float aw = imgAtlas.getWidth();
+	float ah = imgAtlas.getHeight();
+
+	fxToolAtlas = gl::Texture{};
+	glActiveTexture(GL_TEXTURE0);
+	fxToolAtlas.use(GL_TEXTURE_2D);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+	assert((imgAtlas.getChannels() == 4 && imgAtlas.getData() != nullptr)); // must be RGBA
+
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, imgAtlas.getWidth(), imgAtlas.getHeight(),
+			0, GL_RGBA, GL_UNSIGNED_BYTE, imgAtlas.getData());
+
+	program.use();
+	program.setUAtlasSizePx(aw, ah);
+
+	toolVisuals.clear();
+	auto addStates = [&] (const Theme::ToolVisualInfo& tinfo) -> ToolLutEntry {
+		ToolLutEntry e{nullptr, static_cast<u16>(toolVisuals.size()), 0};
+		for (const auto& sinfo : tinfo.states) {
+			toolVisuals.push_back({
+				sinfo.fxAtlasX / aw, sinfo.fxAtlasY / ah,
+				static_cast<float>(sinfo.fxAtlasW), static_cast<float>(sinfo.fxAtlasH),
+				static_cast<float>(sinfo.fxHotspotX), static_cast<float>(sinfo.fxHotspotY)
+			});
+		}
+
+		e.count = std::min<sz_t>(tinfo.states.size(), 255);
+		if (e.count == 0) { // getState() would have read states[0] anyway
+			toolVisuals.push_back({});
+			e.count = 1;
+		}
+
+		return e;
+	};
+
+	// unknown tools, or tools the theme has no icon for, get the first icon
+	ToolLutEntry def = addStates(t.tools[0]);
+	def.count = 1;
+	toolLut.fill(def);
+
+	// visual names don't depend on the tool state for any tool yet, so the local one works
+	tm.forEachTool([&] (int, Tool& tool) {
+		Theme::ToolVisualInfo* tinfo = t.getToolInfo(tool.getToolVisualName(tm.getLocalState()));
+		ToolLutEntry e = tinfo ? addStates(*tinfo) : def;
+		e.tool = &tool;
+		toolLut[tool.getNetId()] = e;
+	});
+
+	themeReady = true;
+}
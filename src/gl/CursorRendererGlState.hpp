@@ -1,22 +1,83 @@
 #pragma once
 
+#include <array>
 #include <vector>
+#include <unordered_map>
 
+#include "util/explints.hpp"
 #include "util/gl/ABuffer.hpp"
 #include "util/gl/Texture.hpp"
 #include "util/gl/VtxArray.hpp"
 
 #include "gl/program/cursor/CursorProgram.hpp"
 
-class Cursor;
+class CursorStore;
 class ToolManager;
+class Tool;
+struct Theme;
 
 class CursorRendererGlState {
+public:
+	struct Stats {
+		u32 drawn;
+		u32 culled; // outside of the viewport
+		u32 rewritten; // instances sent to the gpu this frame
+		u32 crowds; // markers drawn in place of crowded cells
+	};
+
+	static constexpr sz_t instanceFloats = 8;
+	static constexpr sz_t ringSize = 3;
+	static constexpr float cullMarginPx = 64.f; // biggest tool icon in the atlas, in atlas px
+	static constexpr float crowdZoom = 2.f; // crowds are grouped below this zoom
+	static constexpr float crowdCellPx = 24.f; // grouping cell size, in the same units as tool icons
+	static constexpr float crowdDiscPx = 12.f; // marker diameter for the smallest crowd, grows with log2(count)
+	static constexpr u32 crowdMinCount = 4;
+
+private:
+	// a tool state, already in the units of the instance attribs
+	struct ToolVisual {
+		float atlasX;
+		float atlasY;
+		float w;
+		float h;
+		float hotspotX;
+		float hotspotY;
+	};
+
+	struct ToolLutEntry {
+		Tool* tool;
+		u16 first; // in toolVisuals, one per visual state
+		u8 count;
+	};
+
+	struct CrowdCell {
+		u32 count;
+		float sumX;
+		float sumY;
+		bool emitted;
+	};
+
+	struct InstanceBuf {
+		gl::ABuffer buf;
+		u32 capacity; // in instances
+		u32 dirtyBegin; // range changed since this buffer was last written
+		u32 dirtyEnd;
+	};
+
 	gl::ABuffer verts;
-	gl::ABuffer cursorData;
+	// the gpu may still be reading the buffer of the last frame, so each frame writes the next one
+	std::array<InstanceBuf, ringSize> instBufs;
+	std::vector<float> instances; // contents of the newest buffer, to diff against
+	std::vector<u32> visible; // CursorStore slots, reused every frame
+	std::unordered_map<u64, CrowdCell> crowdCells; // by screen cell, reused every frame
 	CursorProgram program;
 	gl::VtxArray vao;
 	gl::Texture fxToolAtlas;
+	std::array<ToolLutEntry, 256> toolLut; // by tool net id
+	std::vector<ToolVisual> toolVisuals;
+	Stats stats;
+	u8 currentBuf;
+	bool themeReady; // atlas uploaded and lut built for the current theme
 
 public:
 	CursorRendererGlState();
@@ -24,8 +85,16 @@ public:
 	bool ok() const;
 
 	CursorProgram& getProgram();
+	const Stats& getStats() const;
 	void use();
-	bool uploadCurData(ToolManager& tm, const std::vector<Cursor>& cursors);
+	// the theme changed, re-upload the atlas and rebuild the lut on the next frame
+	void invalidateTheme();
+	// only cursors inside the given world rect are uploaded, getStats().drawn is the instance count to draw
+	bool uploadCurData(ToolManager& tm, const CursorStore& cursors,
+			float tlx, float tly, float brx, float bry, float worldZoom, float dpr, bool groupCrowds);
 	std::size_t vertexCount();
 
+private:
+	void pointInstanceAttribs();
+	void loadTheme(ToolManager&, Theme&);
 };
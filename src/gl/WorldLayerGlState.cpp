@@ -0,0 +1,137 @@
+#include "WorldLayerGlState.hpp"
+
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+#include <GLES3/gl3.h>
+
+WorldLayerGlState::WorldLayerGlState()
+: fb(nullptr),
+  tex(nullptr),
+  w(0),
+  h(0),
+  outW(0),
+  outH(0),
+  scale(1.f),
+  x0(0),
+  y0(0),
+  x1(0),
+  y1(0),
+  full(true) { }
+
+bool WorldLayerGlState::ok() const {
+	return fb.get() && tex.get();
+}
+
+void WorldLayerGlState::resize(i32 cw, i32 ch) {
+	outW = cw;
+	outH = ch;
+	i32 nw = std::max<i32>(std::ceil(cw * scale), 1);
+	i32 nh = std::max<i32>(std::ceil(ch * scale), 1);
+	if (nw == w && nh == h) {
+		return; // also don't retry a failed size every frame
+	}
+
+	w = nw;
+	h = nh;
+	invalidate();
+
+	tex = gl::Texture{};
+	tex.use(GL_TEXTURE_2D);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, w, h);
+
+	if (!fb.get()) {
+		fb = gl::Framebuffer{};
+	}
+
+	fb.use(GL_FRAMEBUFFER);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex.get(), 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::printf("[WorldLayerGlState] Incomplete framebuffer at %ix%i, drawing directly\n", w, h);
+		tex = nullptr;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void WorldLayerGlState::setScale(float s) {
+	scale = std::clamp(s, 0.1f, 1.f);
+}
+
+float WorldLayerGlState::getScale() const {
+	return scale;
+}
+
+void WorldLayerGlState::invalidate() {
+	full = true;
+}
+
+void WorldLayerGlState::invalidate(i32 x, i32 y, i32 rw, i32 rh) {
+	if (full) {
+		return;
+	}
+
+	// to layer pixels, rounding outwards
+	float sx = static_cast<float>(w) / std::max(outW, 1);
+	float sy = static_cast<float>(h) / std::max(outH, 1);
+	i32 nx0 = std::max<i32>(std::floor(x * sx), 0);
+	i32 ny0 = std::max<i32>(std::floor(y * sy), 0);
+	i32 nx1 = std::min<i32>(std::ceil((x + rw) * sx), w);
+	i32 ny1 = std::min<i32>(std::ceil((y + rh) * sy), h);
+	if (nx0 >= nx1 || ny0 >= ny1) {
+		return; // offscreen
+	}
+
+	if (x0 >= x1) {
+		x0 = nx0; y0 = ny0;
+		x1 = nx1; y1 = ny1;
+	} else {
+		x0 = std::min(x0, nx0); y0 = std::min(y0, ny0);
+		x1 = std::max(x1, nx1); y1 = std::max(y1, ny1);
+	}
+
+	// a scissored redraw of most of the screen isn't worth it
+	if (static_cast<i64>(x1 - x0) * (y1 - y0) * 4 >= static_cast<i64>(w) * h * 3) {
+		full = true;
+	}
+}
+
+WorldLayerGlState::Redraw WorldLayerGlState::pending() const {
+	return full ? Redraw::FULL : x0 < x1 ? Redraw::PARTIAL : Redraw::NONE;
+}
+
+WorldLayerGlState::Redraw WorldLayerGlState::begin() {
+	Redraw r = pending();
+	if (r == Redraw::NONE) {
+		return r;
+	}
+
+	fb.use(GL_FRAMEBUFFER);
+	glViewport(0, 0, w, h);
+	if (r == Redraw::PARTIAL) {
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(x0, y0, x1 - x0, y1 - y0);
+	}
+
+	glClear(GL_COLOR_BUFFER_BIT);
+	return r;
+}
+
+void WorldLayerGlState::end() {
+	glDisable(GL_SCISSOR_TEST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	full = false;
+	x0 = y0 = x1 = y1 = 0;
+}
+
+void WorldLayerGlState::blit() const {
+	fb.use(GL_READ_FRAMEBUFFER);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(0, 0, w, h, 0, 0, outW, outH, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
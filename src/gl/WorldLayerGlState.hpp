@@ -0,0 +1,53 @@
+#pragma once
+
+#include "util/explints.hpp"
+#include "util/gl/Texture.hpp"
+#include "util/gl/Framebuffer.hpp"
+
+// webgl2 only. the composed chunk layer, kept in a texture so frames where only cursors
+// moved are just a blit. only the dirty part of it gets redrawn, scissored. it can be
+// smaller than the canvas, then the blit scales it up with nearest filtering.
+class WorldLayerGlState {
+public:
+	enum class Redraw : u8 {
+		NONE,
+		PARTIAL,
+		FULL
+	};
+
+private:
+	gl::Framebuffer fb;
+	gl::Texture tex;
+	i32 w; // of the layer
+	i32 h;
+	i32 outW; // of the canvas
+	i32 outH;
+	float scale; // layer px per canvas px
+	// dirty area in layer pixels, gl style so y goes up. empty if x0 >= x1
+	i32 x0;
+	i32 y0;
+	i32 x1;
+	i32 y1;
+	bool full;
+
+public:
+	WorldLayerGlState();
+
+	bool ok() const;
+	// canvas size. reallocates if the layer size changed, and then all of it is dirty
+	void resize(i32 w, i32 h);
+	// takes effect on the next resize()
+	void setScale(float);
+	float getScale() const;
+
+	void invalidate();
+	// in canvas pixels, gl style
+	void invalidate(i32 x, i32 y, i32 w, i32 h);
+	Redraw pending() const;
+
+	// binds the layer and clears the dirty area, scissor stays on until end()
+	Redraw begin();
+	void end();
+	// to the default framebuffer
+	void blit() const;
+};
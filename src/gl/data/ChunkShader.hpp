@@ -3,12 +3,13 @@
 #include <string_view>
 #include <initializer_list>
 
+#include "util/explints.hpp"
 #include "world/ChunkConstants.hpp"
 
 // TODO: fix grid rendering when highp is not supported
 #define GLSL_GRID_FUNC " \
-float gridMult() { \
-	vec2 pixelPos = vPosV * zoom; \
+float gridMult(vec2 pos) { \
+	vec2 pixelPos = pos * zoom; \
 	float mult = 1.0; \
 \n\
 #ifndef GL_FRAGMENT_PRECISION_HIGH\n\
@@ -31,6 +32,19 @@ float gridMult() { \
 }"
 
 struct ChunkShader {
+	// #defines the chunk fragment shaders get built with, each combination is its own
+	// program (see ChunkRendererGlState)
+	enum Variant : u8 {
+		V_GRID = 1,
+		V_INVERT = 2,
+		V_SMOOTH = 4, // supersampling for fractional zooms
+		V_NUM = 8
+	};
+
+	static constexpr u8 texturedVariants = V_GRID | V_INVERT | V_SMOOTH;
+	static constexpr u8 backgroundVariants = V_GRID | V_INVERT;
+	static constexpr u8 instancedVariants = V_GRID | V_INVERT | V_SMOOTH;
+
 	// vertex + texcoords
 	static constexpr float chksz = ChunkConstants::size;
 	static constexpr std::initializer_list<float> buffer{
@@ -75,8 +89,6 @@ void main() {
 	precision mediump float;
 #endif
 
-uniform bool showGrid;
-uniform bool invertClrs;
 uniform float chunkSize;
 uniform float zoom;
 uniform vec3 bgClr;
@@ -88,47 +100,44 @@ varying vec2 vPosV;
 
 )" GLSL_GRID_FUNC R"(
 
-const int SAMPLES = 3;
 vec4 smoothTexture2D(sampler2D tex, vec2 texCoord) {
+#ifdef SMOOTH
+	const int SAMPLES = 3;
 	vec2 texCoordDx = vec2(1. / chunkSize / zoom, 0.); /*dFdx(texCoord);*/
-
-	float z = fract(zoom);
-	z = abs(-1. * float(z > 0.5) + z) * 2.;
-
 	vec4 no = vec4(0.0);
 
-	if (zoom < 6. && z > 0.01) {
-		for(int j=0; j < SAMPLES; j++)
-		for(int i=0; i < SAMPLES; i++) {
-			vec2 st = vec2(float(i), float(j)) / float(SAMPLES);
-			vec4 clr = texture2D(tex, texCoord + st.x * texCoordDx + st.y * texCoordDx.yx);
-			no += vec4(clr.rgb * clr.a, clr.a);
-		}
-
-		return no / float(SAMPLES * SAMPLES);
-	} else {
-		no = texture2D(tex, texCoord);
-		return vec4(no.rgb * no.a, no.a);
+	for(int j=0; j < SAMPLES; j++)
+	for(int i=0; i < SAMPLES; i++) {
+		vec2 st = vec2(float(i), float(j)) / float(SAMPLES);
+		vec4 clr = texture2D(tex, texCoord + st.x * texCoordDx + st.y * texCoordDx.yx);
+		no += vec4(clr.rgb * clr.a, clr.a);
 	}
+
+	return no / float(SAMPLES * SAMPLES);
+#else
+	vec4 no = texture2D(tex, texCoord);
+	return vec4(no.rgb * no.a, no.a);
+#endif
 }
 
 void main() {
 	vec4 texClr = smoothTexture2D(pxTex, vTexCoordV);
-	texClr.rgb = bgClr.rgb * (1.0 - texClr.a) + texClr.rgb;
+	// opaque, it goes over the background pass
+	texClr = vec4(bgClr.rgb * (1.0 - texClr.a) + texClr.rgb, 1.0);
 
-	if (showGrid) {
-		float avg = dot(texClr.rgb, vec3(0.2126, 0.7152, 0.0722));
+#ifdef GRID
+	float avg = dot(texClr.rgb, vec3(0.2126, 0.7152, 0.0722));
 
-		vec3 clr = avg < 0.3 ? -(vec3(1.0) - texClr.rgb) : texClr.rgb;
-		vec3 dist = clr.rgb - clr.rgb * gridMult();
-		dist *= avg < 0.3 ? 0.7 : 1.0;
+	vec3 clr = avg < 0.3 ? -(vec3(1.0) - texClr.rgb) : texClr.rgb;
+	vec3 dist = clr.rgb - clr.rgb * gridMult(vPosV);
+	dist *= avg < 0.3 ? 0.7 : 1.0;
 
-		texClr.rgb -= dist;
-	}
+	texClr.rgb -= dist;
+#endif
 
-	if (invertClrs) {
-		texClr.rgb = vec3(1.0) - texClr.rgb;
-	}
+#ifdef INVERT
+	texClr.rgb = vec3(1.0) - texClr.rgb;
+#endif
 
 	gl_FragColor = texClr;
 })"};
@@ -136,7 +145,10 @@ void main() {
 // blending:
 // resultAlpha = 1 - (1 - overlay.alpha) * (1 - base.alpha)
 //(baseComponent * base.alpha * (1 - overlay.alpha) / resultAlpha) + (overlayComponent * overlay.alpha / resultAlpha)
-	static constexpr std::string_view emptyFragment{
+	// one quad over the whole visible chunk rect, under the textured chunks. draws the
+	// background color and grid of every chunk, and the loading animation where the mask
+	// (one texel per chunk) is set
+	static constexpr std::string_view backgroundVertex{
 			R"(#version 100
 #ifdef GL_FRAGMENT_PRECISION_HIGH
 	precision highp float;
@@ -144,38 +156,24 @@ void main() {
 	precision mediump float;
 #endif
 
-uniform bool showGrid;
-uniform bool invertClrs;
-uniform float chunkSize;
-uniform float zoom;
-uniform vec3 bgClr;
+uniform mat4 mat;
+uniform vec2 chunkOffset; // of the top left chunk of the rect
+uniform vec2 rectSize; // in chunks
+
+attribute vec2 vPosA;
+attribute vec2 vTexCoordA;
 
 varying vec2 vTexCoordV;
 varying vec2 vPosV;
 
-)" GLSL_GRID_FUNC R"(
-
 void main() {
-	vec4 texClr = vec4(bgClr, 1.0);
-
-	if (showGrid) {
-		float avg = dot(texClr.rgb, vec3(0.2126, 0.7152, 0.0722));
-
-		vec3 clr = avg < 0.3 ? -(vec3(1.0) - texClr.rgb) : texClr.rgb;
-		vec3 dist = clr.rgb - clr.rgb * gridMult();
-		dist *= avg < 0.3 ? 0.7 : 1.0;
-
-		texClr.rgb -= dist;
-	}
-
-	if (invertClrs) {
-		texClr.rgb = vec3(1.0) - texClr.rgb;
-	}
+	vTexCoordV = vTexCoordA;
+	vPosV = vPosA * rectSize; // relative to the rect, keeps the numbers small
 
-	gl_FragColor = texClr;
+	gl_Position = mat * vec4(chunkOffset + vPosV, 1.0, 1.0);
 })"};
 
-	static constexpr std::string_view loadingFragment{
+	static constexpr std::string_view backgroundFragment{
 			R"(#version 100
 #ifdef GL_FRAGMENT_PRECISION_HIGH
 	precision highp float;
@@ -185,15 +183,16 @@ void main() {
 
 uniform float time;
 
-uniform bool showGrid;
-uniform bool invertClrs;
 uniform float chunkSize;
 uniform float zoom;
 uniform vec3 bgClr;
+uniform sampler2D loadMask;
 
 varying vec2 vTexCoordV;
 varying vec2 vPosV;
 
+)" GLSL_GRID_FUNC R"(
+
 float twave(float i) {
 	return abs(mod(i, 4.0) - 2.0) - 1.0;
 }
@@ -202,33 +201,143 @@ float clamp1(float i) {
 	return clamp(i, -1.0, 1.0);
 }
 
-float animx() {
-	return (clamp1(twave(time) * 3.0) / 3.0 + 0.5) * 8.0 + 4.0;
-}
+vec3 loadingClr(vec2 chunkPos) {
+	float animx = (clamp1(twave(time) * 3.0) / 3.0 + 0.5) * 8.0 + 4.0;
+	float animy = (clamp1(twave(time + 1.0) * 3.0) / 3.0 + 0.5) * 8.0 + 4.0;
+	vec2 pixelPos = floor(chunkPos / (4.0 / zoom));
+
+	float mult = float(
+		(mod(pixelPos.x - pixelPos.y, 16.0) < animx)
+		^^ (mod(pixelPos.x + pixelPos.y, 16.0) < animy)
+	);
 
-float animy() {
-	return (clamp1(twave(time + 1.0) * 3.0) / 3.0 + 0.5) * 8.0 + 4.0;
+	mult *= (sin(time * 2.0) / 4.0) + 1.0;
+	return bgClr * (1.0 - 0.15 + 0.05 * mult);
 }
 
 void main() {
-	vec2 pixelPos = floor(vTexCoordV * chunkSize / (4.0 / zoom));
+	vec2 chunkPos = mod(vPosV, chunkSize);
+	vec4 texClr = vec4(bgClr, 1.0);
 
-	float mult = float(
-		(mod(pixelPos.x - pixelPos.y, 16.0) < animx())
-		^^ (mod(pixelPos.x + pixelPos.y, 16.0) < animy())
-	);
+	if (texture2D(loadMask, vTexCoordV).a > 0.5) {
+		texClr.rgb = loadingClr(chunkPos);
+	} else {
+#ifdef GRID
+		float avg = dot(texClr.rgb, vec3(0.2126, 0.7152, 0.0722));
 
-	float mult2 = (sin(time * 2.0) / 4.0) + 1.0;
-	mult *= mult2;
+		vec3 clr = avg < 0.3 ? -(vec3(1.0) - texClr.rgb) : texClr.rgb;
+		vec3 dist = clr.rgb - clr.rgb * gridMult(chunkPos);
+		dist *= avg < 0.3 ? 0.7 : 1.0;
 
-	vec4 texClr = vec4(bgClr, 1.0);
-	texClr.rgb *= 1.0 - 0.15 + 0.05 * mult;
-	gl_FragColor = invertClrs ? vec4(vec3(1.0) - texClr.rgb, texClr.a) : texClr;
+		texClr.rgb -= dist;
+#endif
+	}
+
+#ifdef INVERT
+	texClr.rgb = vec3(1.0) - texClr.rgb;
+#endif
+
+	gl_FragColor = texClr;
 })"};
 
 	static constexpr std::initializer_list<const char *> attribs{
 		"vPosA", "vTexCoordA"
 	};
+
+	// webgl2, every visible textured chunk in one instanced draw. the instance says
+	// where the chunk is, its layer in the texture arrays and how to draw it (see instState*)
+	static constexpr float instStateTextured = 0.f;
+
+	static constexpr std::string_view instancedVertex{
+			R"(#version 300 es
+precision highp float;
+
+uniform mat4 mat;
+
+in vec2 vPosA;
+in vec2 vTexCoordA;
+in vec2 vChunkOffsetA;
+in vec2 vLayerStateA;
+
+out vec2 vTexCoordV;
+out vec2 vPosV;
+flat out float vLayerV;
+flat out float vStateV;
+
+void main() {
+	vTexCoordV = vTexCoordA;
+	vPosV = vPosA;
+	vLayerV = vLayerStateA.x;
+	vStateV = vLayerStateA.y;
+
+	gl_Position = mat * vec4(vChunkOffsetA + vPosA, 1.0, 1.0);
+})"};
+
+	// same as the textured shader above
+	static constexpr std::string_view instancedFragment{
+			R"(#version 300 es
+precision highp float;
+precision highp sampler2DArray;
+
+uniform float chunkSize;
+uniform float zoom;
+uniform vec3 bgClr;
+uniform sampler2DArray pxTex;
+uniform sampler2DArray protTex;
+
+in vec2 vTexCoordV;
+in vec2 vPosV;
+flat in float vLayerV;
+flat in float vStateV;
+
+out vec4 fragColor;
+
+)" GLSL_GRID_FUNC R"(
+
+vec4 smoothTexture(vec2 texCoord) {
+#ifdef SMOOTH
+	const int SAMPLES = 3;
+	vec2 texCoordDx = vec2(1. / chunkSize / zoom, 0.);
+	vec4 no = vec4(0.0);
+
+	for(int j=0; j < SAMPLES; j++)
+	for(int i=0; i < SAMPLES; i++) {
+		vec2 st = vec2(float(i), float(j)) / float(SAMPLES);
+		vec4 clr = texture(pxTex, vec3(texCoord + st.x * texCoordDx + st.y * texCoordDx.yx, vLayerV));
+		no += vec4(clr.rgb * clr.a, clr.a);
+	}
+
+	return no / float(SAMPLES * SAMPLES);
+#else
+	vec4 no = texture(pxTex, vec3(texCoord, vLayerV));
+	return vec4(no.rgb * no.a, no.a);
+#endif
+}
+
+void main() {
+	vec4 texClr = smoothTexture(vTexCoordV);
+	texClr = vec4(bgClr.rgb * (1.0 - texClr.a) + texClr.rgb, 1.0);
+
+#ifdef GRID
+	float avg = dot(texClr.rgb, vec3(0.2126, 0.7152, 0.0722));
+
+	vec3 clr = avg < 0.3 ? -(vec3(1.0) - texClr.rgb) : texClr.rgb;
+	vec3 dist = clr.rgb - clr.rgb * gridMult(vPosV);
+	dist *= avg < 0.3 ? 0.7 : 1.0;
+
+	texClr.rgb -= dist;
+#endif
+
+#ifdef INVERT
+	texClr.rgb = vec3(1.0) - texClr.rgb;
+#endif
+
+	fragColor = texClr;
+})"};
+
+	static constexpr std::initializer_list<const char *> instancedAttribs{
+		"vPosA", "vTexCoordA", "vChunkOffsetA", "vLayerStateA"
+	};
 };
 
 #undef GLSL_GRID_FUNC
@@ -34,12 +34,16 @@ attribute vec2 vAtlasToolTexSizeA;
 attribute vec2 vAtlasToolTexHotspotA;
 
 varying vec2 vTexCoordV;
+varying float vDiscV;
 
 void main() {
 	float toolZoom = min(worldZoom / dpr, 16.0 / dpr);
-	vTexCoordV = vAtlasToolTexPosA + vAtlasToolTexSizeA / atlasSizePx * vPosA;
+	// a negative size marks a crowd marker: a disc of that diameter instead of a tool icon
+	vDiscV = vAtlasToolTexSizeA.x < 0.0 ? 1.0 : 0.0;
+	vec2 size = abs(vAtlasToolTexSizeA);
+	vTexCoordV = mix(vAtlasToolTexPosA + size / atlasSizePx * vPosA, vPosA * 2.0 - 1.0, vDiscV);
 	vec2 curPos = vCamOffsetA - vAtlasToolTexHotspotA / toolZoom;
-	gl_Position = mat * vec4(curPos + vPosA * (vAtlasToolTexSizeA / toolZoom), 1.0, 1.0);
+	gl_Position = mat * vec4(curPos + vPosA * (size / toolZoom), 1.0, 1.0);
 })"};
 
 static constexpr std::string_view fragment{
@@ -53,8 +57,17 @@ static constexpr std::string_view fragment{
 uniform sampler2D atlasTex;
 
 varying vec2 vTexCoordV;
+varying float vDiscV;
 
 void main() {
+	if (vDiscV > 0.5) {
+		float d = length(vTexCoordV);
+		float a = (1.0 - smoothstep(0.85, 1.0, d)) * 0.75;
+		vec3 clr = mix(vec3(1.0), vec3(0.2, 0.45, 1.0), step(d, 0.8)); // white rim
+		gl_FragColor = vec4(clr * a, a); // premultiplied
+		return;
+	}
+
 	gl_FragColor = texture2D(atlasTex, vTexCoordV);
 })"};
 
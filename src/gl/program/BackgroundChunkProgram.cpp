@@ -0,0 +1,26 @@
+#include "BackgroundChunkProgram.hpp"
+
+#include "gl/data/ChunkShader.hpp"
+
+#include <GLES2/gl2.h>
+
+BackgroundChunkProgram::BackgroundChunkProgram(u8 nVariant)
+: ChunkProgram(ChunkShader::backgroundVertex, ChunkShader::backgroundFragment, ChunkShader::attribs, nVariant),
+  uTime(findUniform("time")),
+  uRectSize(findUniform("rectSize")),
+  uLoadMask(findUniform("loadMask")) {
+	use();
+	setULoadMask(0);
+}
+
+void BackgroundChunkProgram::setUTime(float time) {
+	glUniform1f(uTime, time);
+}
+
+void BackgroundChunkProgram::setURectSize(glm::vec2 chunks) {
+	glUniform2f(uRectSize, chunks.x, chunks.y);
+}
+
+void BackgroundChunkProgram::setULoadMask(std::int32_t sampler2D) {
+	glUniform1i(uLoadMask, sampler2D);
+}
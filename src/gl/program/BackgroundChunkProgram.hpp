@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+#include "gl/program/ChunkProgram.hpp"
+
+#include <glm/vec2.hpp>
+
+// empty and loading chunks, see ChunkShader::backgroundFragment
+class BackgroundChunkProgram : public ChunkProgram {
+	std::int32_t uTime;
+	std::int32_t uRectSize;
+	std::int32_t uLoadMask;
+
+public:
+	BackgroundChunkProgram(u8 variant);
+
+	void setUTime(float time);
+	void setURectSize(glm::vec2 chunks);
+	void setULoadMask(std::int32_t sampler2D);
+};
@@ -7,36 +7,25 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <GLES2/gl2.h>
 
-ChunkProgram::ChunkProgram(std::string_view fshdr)
-: gl::Program(ChunkShader::vertex, fshdr, ChunkShader::attribs),
+ChunkProgram::ChunkProgram(std::string_view fshdr, u8 nVariant)
+: ChunkProgram(ChunkShader::vertex, fshdr, ChunkShader::attribs, nVariant) { }
+
+ChunkProgram::ChunkProgram(std::string_view vshdr, std::string_view fshdr, std::initializer_list<const char *> attribOrder, u8 nVariant)
+: gl::Program(vshdr, withDefines(fshdr, nVariant), attribOrder),
   uMat(findUniform("mat")),
   uZoom(findUniform("zoom")),
-  uShowGrid(findUniform("showGrid")),
-  uInvertClrs(findUniform("invertClrs")),
   uChunkSize(findUniform("chunkSize")),
   uOffset(findUniform("chunkOffset")),
   uBgClr(findUniform("bgClr")),
   lastBgClr(0.f),
   lastZoom(0.f),
-  lastShowGrid(false),
-  lastInvertClrs(false) {
+  variant(nVariant) {
 	use();
-	setUShowGrid(true);
 	setUChunkSize(Chunk::size);
 }
 
-void ChunkProgram::setUShowGrid(bool show) {
-	if (lastShowGrid != show) {
-		glUniform1i(uShowGrid, show);
-		lastShowGrid = show;
-	}
-}
-
-void ChunkProgram::setUInvertColors(bool invert) {
-	if (lastInvertClrs != invert) {
-		glUniform1i(uInvertClrs, invert);
-		lastInvertClrs = invert;
-	}
+u8 ChunkProgram::getVariant() const {
+	return variant;
 }
 
 void ChunkProgram::setUChunkSize(float chunkSize) {
@@ -69,3 +58,24 @@ void ChunkProgram::setUZoom(float zoom) {
 		lastZoom = zoom;
 	}
 }
+
+std::string ChunkProgram::withDefines(std::string_view shdr, u8 variant) {
+	// #version has to stay on the first line
+	sz_t eol = shdr.find('\n') + 1;
+	std::string s(shdr.substr(0, eol));
+
+	if (variant & ChunkShader::V_GRID) {
+		s += "#define GRID\n";
+	}
+
+	if (variant & ChunkShader::V_INVERT) {
+		s += "#define INVERT\n";
+	}
+
+	if (variant & ChunkShader::V_SMOOTH) {
+		s += "#define SMOOTH\n";
+	}
+
+	s += shdr.substr(eol);
+	return s;
+}
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
 
+#include "util/explints.hpp"
 #include "util/gl/Program.hpp"
 
 #include <glm/vec2.hpp>
@@ -11,25 +15,26 @@
 class ChunkProgram : public gl::Program {
 	std::int32_t uMat;
 	std::int32_t uZoom;
-	std::int32_t uShowGrid;
-	std::int32_t uInvertClrs;
 	std::int32_t uChunkSize;
 	std::int32_t uOffset;
 	std::int32_t uBgClr;
 	glm::mat4 lastMat;
 	glm::vec3 lastBgClr;
 	float lastZoom;
-	bool lastShowGrid;
-	bool lastInvertClrs;
+	u8 variant;
 
 public:
-	ChunkProgram(std::string_view fshdr);
+	// variant is a ChunkShader::Variant mask
+	ChunkProgram(std::string_view fshdr, u8 variant);
+	ChunkProgram(std::string_view vshdr, std::string_view fshdr, std::initializer_list<const char *> attribOrder, u8 variant);
 
-	void setUShowGrid(bool show);
-	void setUInvertColors(bool invert);
+	u8 getVariant() const;
 	void setUChunkSize(float uChunkSize);
 	void setUOffset(glm::vec2 chunkOffset);
 	void setUBgClr(glm::vec3 bgClr);
 	void setUMats(const glm::mat4& uProj, const glm::mat4& uView);
 	void setUZoom(float uZoom);
+
+private:
+	static std::string withDefines(std::string_view shdr, u8 variant);
 };
@@ -1,6 +0,0 @@
-#include "EmptyChunkProgram.hpp"
-
-#include "gl/data/ChunkShader.hpp"
-
-EmptyChunkProgram::EmptyChunkProgram()
-: ChunkProgram(ChunkShader::emptyFragment) { }
@@ -1,11 +0,0 @@
-#pragma once
-
-#include <cstdint>
-
-#include "gl/program/ChunkProgram.hpp"
-
-class EmptyChunkProgram : public ChunkProgram {
-public:
-	EmptyChunkProgram();
-};
-
@@ -0,0 +1,22 @@
+#include "InstancedChunkProgram.hpp"
+
+#include "gl/data/ChunkShader.hpp"
+
+#include <GLES2/gl2.h>
+
+InstancedChunkProgram::InstancedChunkProgram(u8 nVariant)
+: ChunkProgram(ChunkShader::instancedVertex, ChunkShader::instancedFragment, ChunkShader::instancedAttribs, nVariant),
+  uPxTex(findUniform("pxTex")),
+  uProtTex(findUniform("protTex")) {
+	use();
+	setUPxTex(0);
+	setUProtTex(1);
+}
+
+void InstancedChunkProgram::setUPxTex(std::int32_t sampler2DArray) {
+	glUniform1i(uPxTex, sampler2DArray);
+}
+
+void InstancedChunkProgram::setUProtTex(std::int32_t sampler2DArray) {
+	glUniform1i(uProtTex, sampler2DArray);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+#include "gl/program/ChunkProgram.hpp"
+
+// webgl2 only, draws the textured chunks in the pool, see ChunkShader::instancedFragment.
+// empty and loading chunks are in the background pass
+class InstancedChunkProgram : public ChunkProgram {
+	std::int32_t uPxTex;
+	std::int32_t uProtTex;
+
+public:
+	InstancedChunkProgram(u8 variant);
+
+	void setUPxTex(std::int32_t sampler2DArray);
+	void setUProtTex(std::int32_t sampler2DArray);
+};
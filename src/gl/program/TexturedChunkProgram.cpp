@@ -4,8 +4,8 @@
 
 #include <GLES2/gl2.h>
 
-TexturedChunkProgram::TexturedChunkProgram()
-: ChunkProgram(ChunkShader::texturedFragment),
+TexturedChunkProgram::TexturedChunkProgram(u8 nVariant)
+: ChunkProgram(ChunkShader::texturedFragment, nVariant),
   uPxTex(findUniform("pxTex")),
   uProtTex(findUniform("protTex")) {
 	use();
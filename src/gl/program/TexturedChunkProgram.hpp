@@ -9,7 +9,7 @@ class TexturedChunkProgram : public ChunkProgram {
 	std::int32_t uProtTex;
 
 public:
-	TexturedChunkProgram();
+	TexturedChunkProgram(u8 variant);
 
 	void setUPxTex(std::int32_t sampler2D);
 	void setUProtTex(std::int32_t sampler2D);
@@ -7,8 +7,12 @@ GeneralSettings::GeneralSettings()
   showGrid(S::get().showGrid, "Show grid"),
   invertClrs(S::get().invertClrs, "Inverted world colors"),
   nativeRes(S::get().nativeRes, "Native resolution"),
+  autoRes(S::get().autoRes, "Automatic resolution"),
   showProtectionZones(S::get().showProtectionZones, "Show protection zones"),
   hideAllPlayers(S::get().hideAllPlayers, "Hide all players"),
+  groupCrowds(S::get().groupCrowds, "Group crowded players when zoomed out"),
+  hdrNetwork("h1"),
+  clockSync(S::get().clockSync, "Measure latency (needs server support)"),
   hdrAudio("h1"),
   enableAudio(S::get().enableAudio, "Enable audio"),
   enableWorldAudio(S::get().enableWorldAudio, "Enable custom world audio"),
@@ -21,8 +25,14 @@ GeneralSettings::GeneralSettings()
 	showGrid.appendTo(*this);
 	invertClrs.appendTo(*this);
 	nativeRes.appendTo(*this);
+	autoRes.appendTo(*this);
 	showProtectionZones.appendTo(*this);
 	hideAllPlayers.appendTo(*this);
+	groupCrowds.appendTo(*this);
+
+	hdrNetwork.setProperty("textContent", "Network");
+	hdrNetwork.appendTo(*this);
+	clockSync.appendTo(*this);
 
 	hdrAudio.setProperty("textContent", "Audio");
 	hdrAudio.appendTo(*this);
@@ -14,8 +14,12 @@ class GeneralSettings : public eui::Object {
 	LabelledOption<decltype(S::showGrid)> showGrid;
 	LabelledOption<decltype(S::invertClrs)> invertClrs;
 	LabelledOption<decltype(S::nativeRes)> nativeRes;
+	LabelledOption<decltype(S::autoRes)> autoRes;
 	LabelledOption<decltype(S::showProtectionZones)> showProtectionZones;
 	LabelledOption<decltype(S::hideAllPlayers)> hideAllPlayers;
+	LabelledOption<decltype(S::groupCrowds)> groupCrowds;
+	eui::Object hdrNetwork;
+	LabelledOption<decltype(S::clockSync)> clockSync;
 	eui::Object hdrAudio;
 	LabelledOption<decltype(S::enableAudio)> enableAudio;
 	LabelledOption<decltype(S::enableWorldAudio)> enableWorldAudio;
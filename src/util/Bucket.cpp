@@ -1,15 +1,21 @@
 #include "util/Bucket.hpp"
 #include "emsc/time.hpp"
 
-Bucket::Bucket(Bucket::Rate rate, Bucket::Per per)
-: rate(rate),
-  per(per),
-  allowance(rate) { }
+static std::chrono::steady_clock::time_point measuredAt(float age) {
+	using namespace std::chrono;
+	return getStClock(true) - duration_cast<steady_clock::duration>(duration<float>(age));
+}
+
+Bucket::Bucket(Bucket::Rate nrate, Bucket::Per nper)
+: rate(nrate),
+  per(nper < 1 ? 1 : nper),
+  allowance(nrate) { }
 
-Bucket::Bucket(Bucket::Rate rate, Bucket::Per per, Bucket::Allowance allowance)
-: rate(rate),
-  per(per),
-  allowance(allowance) { }
+Bucket::Bucket(Bucket::Rate nrate, Bucket::Per nper, Bucket::Allowance nallowance, float age)
+: rate(nrate),
+  per(nper < 1 ? 1 : nper),
+  allowance(nallowance),
+  lastCheck(measuredAt(age)) { }
 
 void Bucket::set(Bucket::Rate nrate, Bucket::Per nper) {
 	rate = nrate;
@@ -19,10 +25,12 @@ void Bucket::set(Bucket::Rate nrate, Bucket::Per nper) {
 	}
 }
 
-void Bucket::set(Bucket::Rate nrate, Bucket::Per nper, Bucket::Allowance nallowance) {
+void Bucket::set(Bucket::Rate nrate, Bucket::Per nper, Bucket::Allowance nallowance, float age) {
 	rate = nrate;
 	per = nper < 1 ? 1 : nper;
 	allowance = nallowance;
+	// or the time since the last spend would be added on top
+	lastCheck = measuredAt(age);
 }
 
 bool Bucket::canSpend(Rate count) const {
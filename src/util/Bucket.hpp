@@ -18,10 +18,11 @@ private:
 
 public:
 	Bucket(Rate, Per);
-	Bucket(Rate, Per, Allowance);
+	// age: seconds since the allowance was measured, it refills for that long
+	Bucket(Rate, Per, Allowance, float age = 0.f);
 
 	void set(Rate, Per);
-	void set(Rate, Per, Allowance);
+	void set(Rate, Per, Allowance, float age = 0.f);
 
 	bool canSpend(Rate = 1) const;
 	bool spend(Rate = 1);
@@ -18,6 +18,14 @@ namespace buf {
 
 	template <typename Number>
 	Number readBE(const std::uint8_t *) noexcept;
+
+
+	/* Bulk versions for contiguous arrays, the buffer doesn't need to be aligned */
+	template <typename Number>
+	void writeBEArray(std::uint8_t * __restrict, const Number * __restrict, std::size_t count) noexcept;
+
+	template <typename Number>
+	void readBEArray(Number * __restrict, const std::uint8_t * __restrict, std::size_t count) noexcept;
 };
 
 #include "util/BufferHelper.tpp" // IWYU pragma: keep
@@ -2,31 +2,44 @@
 #include "BufferHelper.hpp"
 #include "util/byteswap.hpp"
 #include <cstring>
+#include <type_traits>
 
 
 static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__,
 	"Host endianness not supported!");
 
 namespace buf {
+	namespace detail {
+		template <std::size_t> struct UintOfSize;
+		template <> struct UintOfSize<1> { using type = std::uint8_t; };
+		template <> struct UintOfSize<2> { using type = std::uint16_t; };
+		template <> struct UintOfSize<4> { using type = std::uint32_t; };
+		template <> struct UintOfSize<8> { using type = std::uint64_t; };
+
+		// swaps the representation, not the value, so floats survive
+		template <typename Number>
+		Number bswap(Number n) noexcept {
+			using U = typename UintOfSize<sizeof(Number)>::type;
+			U bits;
+			std::memcpy(&bits, &n, sizeof(Number));
+
+			if constexpr (sizeof(Number) == 2) {
+				bits = bswap_16(bits);
+			} else if constexpr (sizeof(Number) == 4) {
+				bits = bswap_32(bits);
+			} else if constexpr (sizeof(Number) == 8) {
+				bits = bswap_64(bits);
+			}
+
+			std::memcpy(&n, &bits, sizeof(Number));
+			return n;
+		}
+	}
+
 	template <typename Number>
 	std::size_t writeLE(std::uint8_t * const buf, Number integer) noexcept {
 #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-		switch (sizeof(Number)) {
-		case 1:
-			break;
-
-		case 2:
-			integer = bswap_16(integer);
-			break;
-
-		case 4:
-			integer = bswap_32(integer);
-			break;
-
-		case 8:
-			integer = bswap_64(integer);
-			break;
-		}
+		integer = detail::bswap(integer);
 #endif
 		std::memcpy(buf, &integer, sizeof(Number));
 		return sizeof(Number);
@@ -35,22 +48,7 @@ namespace buf {
 	template <typename Number>
 	std::size_t writeBE(std::uint8_t * const buf, Number integer) noexcept {
 #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
-		switch (sizeof(Number)) {
-		case 1:
-			break;
-
-		case 2:
-			integer = bswap_16(integer);
-			break;
-
-		case 4:
-			integer = bswap_32(integer);
-			break;
-
-		case 8:
-			integer = bswap_64(integer);
-			break;
-		}
+		integer = detail::bswap(integer);
 #endif
 		std::memcpy(buf, &integer, sizeof(Number));
 		return sizeof(Number);
@@ -62,22 +60,7 @@ namespace buf {
 		Number finalBytes;
 		std::memcpy(&finalBytes, buf, sizeof(Number));
 #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
-		switch (sizeof(Number)) {
-		case 1:
-			break;
-
-		case 2:
-			finalBytes = bswap_16(finalBytes);
-			break;
-
-		case 4:
-			finalBytes = bswap_32(finalBytes);
-			break;
-
-		case 8:
-			finalBytes = bswap_64(finalBytes);
-			break;
-		}
+		finalBytes = detail::bswap(finalBytes);
 #endif
 		return finalBytes;
 	}
@@ -87,23 +70,59 @@ namespace buf {
 		Number finalBytes;
 		std::memcpy(&finalBytes, buf, sizeof(Number));
 #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
-		switch (sizeof(Number)) {
-		case 1:
-			break;
+		finalBytes = detail::bswap(finalBytes);
+#endif
+		return finalBytes;
+	}
 
-		case 2:
-			finalBytes = bswap_16(finalBytes);
-			break;
+	template <typename Number>
+	void writeBEArray(std::uint8_t * const __restrict buf, const Number * __restrict nums, std::size_t count) noexcept {
+		if (!count) {
+			return;
+		}
 
-		case 4:
-			finalBytes = bswap_32(finalBytes);
-			break;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		if constexpr (sizeof(Number) > 1) {
+			// fixed size memcpys become plain (unaligned) loads and stores, so this vectorizes.
+			// without restrict the byte stores could alias nums and it wouldn't
+			for (std::size_t i = 0; i < count; i++) {
+				Number n = detail::bswap(nums[i]);
+				std::memcpy(buf + i * sizeof(Number), &n, sizeof(Number));
+			}
+
+			return;
+		}
+#endif
+		std::memcpy(buf, nums, count * sizeof(Number));
+	}
 
-		case 8:
-			finalBytes = bswap_64(finalBytes);
-			break;
+	template <typename Number>
+	void readBEArray(Number * __restrict nums, const std::uint8_t * const __restrict buf, std::size_t count) noexcept {
+		if constexpr (std::is_same_v<Number, bool>) {
+			// any byte other than 0 or 1 would be an invalid bool
+			for (std::size_t i = 0; i < count; i++) {
+				nums[i] = buf[i] != 0;
+			}
+
+			return;
+		}
+
+		if (!count) {
+			return;
+		}
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		if constexpr (sizeof(Number) > 1) {
+			// one pass, a memcpy of everything and then swapping in place reads it all twice
+			for (std::size_t i = 0; i < count; i++) {
+				Number n;
+				std::memcpy(&n, buf + i * sizeof(Number), sizeof(Number));
+				nums[i] = detail::bswap(n);
+			}
+
+			return;
 		}
 #endif
-		return finalBytes;
+		std::memcpy(nums, buf, count * sizeof(Number));
 	}
 };
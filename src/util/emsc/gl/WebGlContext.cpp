@@ -37,6 +37,7 @@ WebGlContext::WebGlContext(const char * targetCanvas, const char * targetSizeEle
   realSizeCache{-1, -1},
   dprCache(-1.0),
   renderLoopSet(false),
+  webgl2(false),
   renderPaused(false) {
 	activateRenderingContext(forceWebgl1);
 }
@@ -58,6 +59,7 @@ WebGlContext::WebGlContext(WebGlContext&& other)
   realSizeCache(std::exchange(other.realSizeCache, {-1, -1})),
   dprCache(std::exchange(other.dprCache, -1)),
   renderLoopSet(other.renderLoopSet),
+  webgl2(other.webgl2),
   renderPaused(other.renderPaused) {
 	if (ctxInfo > 0) {
 		emscripten_set_webglcontextlost_callback(targetCanvas, this, true, emEvent);
@@ -82,6 +84,7 @@ WebGlContext& WebGlContext::operator=(WebGlContext&& other) {
 	realSizeCache = std::exchange(other.realSizeCache, {-1, -1});
 	dprCache = std::exchange(other.dprCache, -1);
 	renderLoopSet = other.renderLoopSet;
+	webgl2 = other.webgl2;
 	renderPaused = other.renderPaused;
 
 	if (ctxInfo > 0) {
@@ -222,6 +225,7 @@ bool WebGlContext::activateRenderingContextAs(bool webgl1) {
 		onEvtResize(0, nullptr, this);
 	});
 
+	webgl2 = !webgl1;
 	std::printf("[WebGlContext] Created WebGL%c rendering context\n", webgl1 ? '1' : '2');
 
 	return true;
@@ -310,6 +314,14 @@ bool WebGlContext::ok() const {
 	return ctxInfo > 0;
 }
 
+bool WebGlContext::isWebgl2() const {
+	return ctxInfo > 0 && webgl2;
+}
+
+bool WebGlContext::enableExtension(const char * name) {
+	return ctxInfo > 0 && emscripten_webgl_enable_extension(ctxInfo, name) == EM_TRUE;
+}
+
 bool WebGlContext::pauseRendering() {
 	if (!renderLoopSet) {
 		return false;
@@ -19,6 +19,7 @@ class WebGlContext : public GlContext {
 	mutable Size<int> realSizeCache;
 	mutable double dprCache;
 	bool renderLoopSet;
+	bool webgl2;
 	bool renderPaused;
 
 	// this shouldn't be here
@@ -41,6 +42,8 @@ public:
 	double getDpr() const;
 
 	bool ok() const;
+	bool isWebgl2() const;
+	bool enableExtension(const char *);
 
 	bool pauseRendering();
 	bool resumeRendering();
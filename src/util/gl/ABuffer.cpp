@@ -19,4 +19,8 @@ void ABuffer::data(std::size_t size, const void *data, std::uint32_t usage) {
 	Buffer::data(GL_ARRAY_BUFFER, size, data, usage);
 }
 
+void ABuffer::subData(std::size_t offset, std::size_t size, const void *data) {
+	Buffer::subData(GL_ARRAY_BUFFER, offset, size, data);
+}
+
 } /* namespace gl */
@@ -16,6 +16,7 @@ public:
 
 	void use() const;
 	void data(std::size_t size, const void * data, std::uint32_t usage);
+	void subData(std::size_t offset, std::size_t size, const void * data);
 };
 
 } /* namespace gl */
@@ -32,6 +32,12 @@ void Buffer::data(std::uint32_t type, std::size_t size, const void *data,
 	glBufferData(type, size, data, usage);
 }
 
+void Buffer::subData(std::uint32_t type, std::size_t offset, std::size_t size,
+		const void *data) {
+	use(type);
+	glBufferSubData(type, offset, size, data);
+}
+
 std::uint32_t Buffer::get() const {
 	return id;
 }
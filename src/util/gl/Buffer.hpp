@@ -19,6 +19,7 @@ public:
 
 	void use(std::uint32_t type) const;
 	void data(std::uint32_t type, std::size_t size, const void * data, std::uint32_t usage);
+	void subData(std::uint32_t type, std::size_t offset, std::size_t size, const void * data);
 	std::uint32_t get() const;
 
 private:
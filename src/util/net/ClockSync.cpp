@@ -0,0 +1,91 @@
+#include "util/net/ClockSync.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+// weights of the newest sample, same as tcp's srtt and rttvar
+static constexpr double srttGain = 1.0 / 8.0;
+static constexpr double jitterGain = 1.0 / 4.0;
+
+ClockSync::ClockSync() {
+	reset();
+}
+
+void ClockSync::reset() {
+	samples.fill({0.0, 0.0});
+	inFlight.fill({0.0, 0, false});
+	stats = {};
+	nextSample = 0;
+	nextSeq = 0;
+}
+
+u16 ClockSync::sent(double localNow) {
+	u16 seq = nextSeq++;
+	Ping& p = inFlight[seq % maxInFlight];
+	if (p.pending) {
+		++stats.lost;
+	}
+
+	p = {localNow, seq, true};
+	return seq;
+}
+
+bool ClockSync::received(u16 seq, double serverNow, double localNow) {
+	Ping& p = inFlight[seq % maxInFlight];
+	if (!p.pending || p.seq != seq) {
+		return false; // too old, or never sent
+	}
+
+	p.pending = false;
+	double rtt = std::max(localNow - p.sentAt, 0.0);
+	// the server read its clock somewhere in the middle of the round trip
+	double offset = serverNow + rtt / 2.0 - localNow;
+
+	if (stats.samples == 0) {
+		stats.srtt = rtt;
+		stats.jitter = rtt / 2.0;
+	} else {
+		stats.jitter += (std::abs(stats.srtt - rtt) - stats.jitter) * jitterGain;
+		stats.srtt += (rtt - stats.srtt) * srttGain;
+	}
+
+	stats.rtt = rtt;
+	++stats.samples;
+	samples[nextSample] = {rtt, offset};
+	nextSample = (nextSample + 1) % window;
+	pickOffset();
+	return true;
+}
+
+bool ClockSync::isSynced() const {
+	return stats.samples >= minSamples;
+}
+
+double ClockSync::getOneWayDelay() const {
+	return isSynced() ? stats.srtt / 2.0 : 0.0;
+}
+
+double ClockSync::toServerTime(double local) const {
+	return local + stats.offset;
+}
+
+double ClockSync::toLocalTime(double server) const {
+	return server - stats.offset;
+}
+
+const ClockSync::Stats& ClockSync::getStats() const {
+	return stats;
+}
+
+void ClockSync::pickOffset() {
+	sz_t n = std::min<sz_t>(stats.samples, window);
+	const Sample * best = &samples[0];
+	for (sz_t i = 1; i < n; i++) {
+		if (samples[i].rtt < best->rtt) {
+			best = &samples[i];
+		}
+	}
+
+	stats.minRtt = best->rtt;
+	stats.offset = best->offset;
+}
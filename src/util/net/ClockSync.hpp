@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+
+#include "util/explints.hpp"
+
+// estimates the server clock from ping/pong round trips. the offset comes from the
+// fastest sample in a window, since the one with the least queueing delay is the
+// one where rtt/2 is closest to the real one way delay. all times are in ms
+class ClockSync {
+public:
+	struct Stats {
+		double rtt; // last sample
+		double srtt; // smoothed
+		double minRtt; // in the window
+		double jitter; // smoothed mean deviation of the rtt
+		double offset; // server time - local time
+		u32 samples;
+		u32 lost; // pings without a pong by the time their seq came around again
+	};
+
+	static constexpr sz_t window = 16;
+	static constexpr u32 minSamples = 3; // before the offset is trusted
+	static constexpr sz_t maxInFlight = 8;
+
+private:
+	struct Sample {
+		double rtt;
+		double offset;
+	};
+
+	struct Ping {
+		double sentAt;
+		u16 seq;
+		bool pending;
+	};
+
+	std::array<Sample, window> samples;
+	std::array<Ping, maxInFlight> inFlight;
+	Stats stats;
+	sz_t nextSample;
+	u16 nextSeq;
+
+public:
+	ClockSync();
+
+	void reset();
+
+	// returns the seq to put in the ping
+	u16 sent(double localNow);
+	// false if the seq wasn't one we're waiting for
+	bool received(u16 seq, double serverNow, double localNow);
+
+	bool isSynced() const;
+	// how long messages from the server take to arrive, srtt / 2. 0 until synced
+	double getOneWayDelay() const;
+	double toServerTime(double local) const;
+	double toLocalTime(double server) const;
+	const Stats& getStats() const;
+
+private:
+	void pickOffset();
+};
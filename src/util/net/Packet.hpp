@@ -3,6 +3,7 @@
 #include "util/explints.hpp"
 #include <tuple>
 #include <memory>
+#include <optional>
 #include <vector>
 
 
@@ -14,9 +15,12 @@ struct Packet {
 	Packet() = delete;
 	//Packet(Args... args);
 
-	// maybe could be changed to std::optional to avoid exceptions
 	// NOTE: doesn't read opcode!
 	static std::tuple<Args...> fromBuffer(const u8 * buffer, sz_t size);
+	// validates the whole buffer first, returns nullopt instead of terminating on malformed data.
+	// the decode after that is unchecked and reserves containers from the validated lengths
+	static std::optional<std::tuple<Args...>> tryFromBuffer(const u8 * buffer, sz_t size);
+	static bool validate(const u8 * buffer, sz_t size);
 
 	static std::tuple<std::unique_ptr<u8[]>, sz_t> toBuffer(const Args&... args);
 	static void toBuffer(std::vector<u8>& out, const Args&... args);
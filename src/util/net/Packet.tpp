@@ -139,6 +139,59 @@ typename std::enable_if<std::is_same_v<R, uvar> || std::is_same_v<R, ivar>,
 	R>::type
 readFromBuf(const u8 *& b, sz_t remaining);
 
+//////////////////////////////
+// Fixed layout tuples (all fields arithmetic) have the same byte offsets for
+// every element, so arrays of them are walked once with compile-time offsets
+// instead of going through readFromBuf/writeToBuf per field.
+
+template<class Tuple, std::size_t... Is>
+constexpr std::array<sz_t, sizeof... (Is)> packedOffsets(std::index_sequence<Is...>) {
+	std::array<sz_t, sizeof... (Is)> offs{};
+	sz_t off = 0;
+	((offs[Is] = off, off += sizeof(std::tuple_element_t<Is, Tuple>)), ...);
+	return offs;
+}
+
+template<class Tuple>
+constexpr auto packedOffsetsOf = packedOffsets<Tuple>(std::make_index_sequence<std::tuple_size<Tuple>::value>{});
+
+template<class Tuple, typename Fn, std::size_t... Is>
+decltype(auto) applyPacked(const u8 * b, Fn& fn, std::index_sequence<Is...>) {
+	constexpr auto& offs = packedOffsetsOf<Tuple>;
+	return fn(buf::readBE<std::tuple_element_t<Is, Tuple>>(b + offs[Is])...);
+}
+
+template<class Tuple, std::size_t... Is>
+void packedTupleToBuf(u8 * b, const Tuple& t, std::index_sequence<Is...>) {
+	constexpr auto& offs = packedOffsetsOf<Tuple>;
+	(buf::writeBE(b + offs[Is], std::get<Is>(t)), ...);
+}
+
+// calls fn(fields...) for count packed records, no bounds checks. the container
+// readers build their elements with it. a callback that writes through pointers it
+// keeps in its captures gets them stored back every record, so it's slower than it looks
+template<class Tuple, typename Fn>
+requires is_tuple_arithmetic<Tuple>::value
+void readPackedArray(const u8 * b, sz_t count, Fn&& fn) {
+	constexpr sz_t stride = is_tuple_arithmetic<Tuple>::size;
+	for (sz_t i = 0; i < count; i++) {
+		applyPacked<Tuple>(b + i * stride, fn, std::make_index_sequence<std::tuple_size<Tuple>::value>{});
+	}
+}
+
+template<class Tuple>
+requires is_tuple_arithmetic<Tuple>::value
+Tuple readPacked(const u8 * b) {
+	auto mk = [] (auto... fields) { return Tuple{fields...}; };
+	return applyPacked<Tuple>(b, mk, std::make_index_sequence<std::tuple_size<Tuple>::value>{});
+}
+
+template<class Tuple>
+requires is_tuple_arithmetic<Tuple>::value
+void writePacked(u8 * b, const Tuple& t) {
+	packedTupleToBuf(b, t, std::make_index_sequence<std::tuple_size<Tuple>::value>{});
+}
+
 //////////////////////////////
 
 template<typename N>
@@ -169,11 +222,13 @@ getSize(const Container& c) {
 	using T = typename Container::value_type;
 	using Result = is_tuple_arithmetic<T>;
 
-	if constexpr (Result::value) {
+	if constexpr (is_std_array<Container>::value && std::is_arithmetic<T>::value) {
+		return sizeof(T) * c.size(); // static arrays have no length prefix
+	} else if constexpr (Result::value) {
 		return unsignedVarintSize(c.size()) + Result::size * c.size();
 	}
 
-	sz_t size = unsignedVarintSize(c.size());
+	sz_t size = is_std_array<Container>::value ? 0 : unsignedVarintSize(c.size());
 	for (const T& v : c) {
 		size += getSize(v);
 	}
@@ -211,12 +266,27 @@ sz_t tupleToBuf(u8 *& b, const Tuple& t, sz_t remaining, std::index_sequence<Is.
 
 template<typename... Ts>
 sz_t writeToBuf(u8 *& b, const std::tuple<Ts...>& t, sz_t remaining) {
-	return tupleToBuf(b, t, remaining, std::index_sequence_for<Ts...>{});
+	if constexpr (are_all_arithmetic<Ts...>::value) {
+		constexpr sz_t size = add(sizeof(Ts)...);
+		assert(remaining >= size);
+		writePacked(b, t);
+		b += size;
+		return size;
+	} else {
+		return tupleToBuf(b, t, remaining, std::index_sequence_for<Ts...>{});
+	}
 }
 
 template<typename T, std::size_t N>
 sz_t writeToBuf(u8 *& b, const std::array<T, N>& arr, sz_t remaining) {
-	return tupleToBuf(b, arr, remaining, std::make_index_sequence<N>{});
+	if constexpr (std::is_arithmetic<T>::value) {
+		assert(remaining >= sizeof(T) * N);
+		buf::writeBEArray(b, arr.data(), N);
+		b += sizeof(T) * N;
+		return sizeof(T) * N;
+	} else {
+		return tupleToBuf(b, arr, remaining, std::make_index_sequence<N>{});
+	}
 }
 
 template<typename Container>
@@ -231,12 +301,24 @@ writeToBuf(u8 *& b, const Container& c, sz_t remaining) {
 	assert(remaining >= byteSize);
 	b += encodeUnsignedVarint(b, c.size());
 
-	if (std::is_arithmetic<T>::value && sizeof(T) == 1) {
+	if constexpr (std::is_arithmetic<T>::value && requires { c.data(); }) {
 		byteSize += c.size() * sizeof(T);
 		assert(remaining >= byteSize);
-		b = reinterpret_cast<u8 *>(
-			std::copy(c.cbegin(), c.cend(), reinterpret_cast<T *>(b))
-		);
+		buf::writeBEArray(b, c.data(), c.size());
+		b += c.size() * sizeof(T);
+	} else if constexpr (is_tuple_arithmetic<T>::value) {
+		constexpr sz_t stride = is_tuple_arithmetic<T>::size;
+		byteSize += c.size() * stride;
+		assert(remaining >= byteSize);
+
+		// a local cursor, the byte stores could alias b itself and it'd be reloaded every field
+		u8 * p = b;
+		for (const T& v : c) {
+			writePacked(p, v);
+			p += stride;
+		}
+
+		b = p;
 	} else {
 		for (const T& v : c) {
 			byteSize += writeToBuf(b, v, remaining - byteSize);
@@ -297,20 +379,30 @@ readFromBuf(const u8 *& b, sz_t remaining) {
 		maybe__throw BUFFER_ERROR;
 	}
 
-	const u8 * readAt = b;
-	sz_t decodedBytes;
-	u64 size = decodeUnsignedVarint(readAt, decodedBytes, remaining);
+	sz_t decodedBytes = 0;
+	u64 size = decodeUnsignedVarint(b, decodedBytes, remaining);
 
-	if (remaining - decodedBytes < size * sizeof(T)) {
+	if (!decodedBytes || size > (remaining - decodedBytes) / sizeof(T)) {
 		maybe__throw BUFFER_ERROR;
 	}
 
-	b += decodedBytes + size * sizeof(T);
-	readAt += decodedBytes;
-	return Container(
-		reinterpret_cast<const T *>(readAt),
-		reinterpret_cast<const T *>(b)
-	); // guaranteed copy ellsion in c++17
+	b += decodedBytes;
+
+	Container c;
+	if constexpr (requires { c.data(); }) {
+		// the source bytes are big endian and may be unaligned, so copy + swap in bulk
+		c.resize(size);
+		buf::readBEArray(c.data(), b, size);
+		b += size * sizeof(T);
+	} else {
+		c.reserve(size);
+		while (size-- > 0) {
+			c.push_back(buf::readBE<T>(b));
+			b += sizeof(T);
+		}
+	}
+
+	return c;
 }
 
 template<typename Container>
@@ -325,10 +417,10 @@ readFromBuf(const u8 *& b, sz_t remaining) {
 		maybe__throw BUFFER_ERROR;
 	}
 
-	sz_t decodedBytes;
+	sz_t decodedBytes = 0;
 	u64 size = decodeUnsignedVarint(b, decodedBytes, remaining);
 
-	if (remaining - decodedBytes < size) { /* size of the elements will be 1 at least */
+	if (!decodedBytes || remaining - decodedBytes < size) { /* size of the elements will be 1 at least */
 		maybe__throw BUFFER_ERROR;
 	}
 
@@ -336,6 +428,22 @@ readFromBuf(const u8 *& b, sz_t remaining) {
 	remaining -= decodedBytes;
 
 	Container c;
+	if constexpr (is_tuple_arithmetic<T>::value) {
+		constexpr sz_t stride = is_tuple_arithmetic<T>::size;
+		if (size > remaining / stride) {
+			maybe__throw BUFFER_ERROR;
+		}
+
+		// one bounds check for the whole run, then a single pass
+		c.reserve(size);
+		readPackedArray<T>(b, size, [&c] (auto... fields) {
+			c.emplace_back(fields...);
+		});
+
+		b += size * stride;
+		return c;
+	}
+
 	c.reserve(size); // XXX: could fill ram lol
 	while (size-- > 0) {
 		const u8 * prev = b;
@@ -357,20 +465,17 @@ template<class Tuple>
 typename std::enable_if<is_tuple<Tuple>::value,
 	Tuple>::type
 readFromBuf(const u8 *& b, sz_t remaining) {
-	return tupleFromBuf<Tuple>(b, remaining, std::make_index_sequence<std::tuple_size<Tuple>::value>{});
-}
-
-template<class Array, std::size_t... Is>
-Array staticArrayFromBuf(const u8 *& b, std::index_sequence<Is...>) {
-	using T = typename Array::value_type;
-
-	const u8 * start = b;
-	b += sizeof(T) * sizeof... (Is);
+	if constexpr (is_tuple_arithmetic<Tuple>::value) {
+		constexpr sz_t size = is_tuple_arithmetic<Tuple>::size;
+		if (remaining < size) {
+			maybe__throw BUFFER_ERROR;
+		}
 
-	if constexpr (sizeof(T) == 1) {
-		return Array{start[Is]...};
+		const u8 * readAt = b;
+		b += size;
+		return readPacked<Tuple>(readAt);
 	} else {
-		return Array{buf::readBE<T>(start + Is * sizeof(T))...};
+		return tupleFromBuf<Tuple>(b, remaining, std::make_index_sequence<std::tuple_size<Tuple>::value>{});
 	}
 }
 
@@ -386,10 +491,13 @@ readFromBuf(const u8 *& b, sz_t remaining) {
 			maybe__throw BUFFER_ERROR;
 		}
 
-		return staticArrayFromBuf<Array>(b, std::make_index_sequence<size>{});
+		Array arr;
+		buf::readBEArray(arr.data(), b, size);
+		b += sizeof(T) * size;
+		return arr;
 	} else {
 		// this works for arrays too, cool!
-		return tupleFromBuf(b, remaining, std::make_index_sequence<size>{});
+		return tupleFromBuf<Array>(b, remaining, std::make_index_sequence<size>{});
 	}
 }
 
@@ -421,6 +529,232 @@ readFromBuf(const u8 *& b, sz_t remaining) {
 	return val;
 }
 
+// container lengths in the order validateBuf met them. extract() takes them back in
+// the same order, so it can reserve exact sizes without decoding the prefixes again.
+class Lengths {
+public:
+	struct Len {
+		u64 n;
+		sz_t prefixBytes;
+	};
+
+private:
+	std::vector<Len> lens;
+	sz_t next;
+
+public:
+	Lengths() : lens(), next(0) { }
+
+	void clear() { lens.clear(); next = 0; }
+	void push(u64 n, sz_t prefixBytes) { lens.push_back({n, prefixBytes}); }
+	Len pop() { return lens[next++]; }
+};
+
+// reused by every packet, the client decodes one message at a time
+inline Lengths& scratchLengths() {
+	static Lengths lens;
+	return lens;
+}
+
+// walks the buffer the same way readFromBuf<T> would, without building anything.
+// once a buffer is validated, none of the readFromBuf checks can fail on it.
+inline bool validateLength(const u8 *& b, sz_t remaining, u64& length, Lengths& lens) {
+	if (!remaining) {
+		return false;
+	}
+
+	sz_t decodedBytes = 0; // not set by the decoder on error
+	length = decodeUnsignedVarint(b, decodedBytes, remaining);
+	b += decodedBytes;
+	lens.push(length, decodedBytes);
+
+	return decodedBytes != 0;
+}
+
+template<typename T>
+bool validateBuf(const u8 *& b, sz_t remaining, Lengths& lens) {
+	const u8 * start = b;
+
+	if constexpr (std::is_arithmetic<T>::value) {
+		if (remaining < sizeof(T)) {
+			return false;
+		}
+
+		b += sizeof(T);
+		return true;
+	} else if constexpr (std::is_same_v<T, uvar> || std::is_same_v<T, ivar>) {
+		// only the end matters here, extract() decodes the value
+		sz_t maxBytes = std::min(remaining, sizeof(typename T::value_type));
+		for (sz_t i = 0; i < maxBytes; i++) {
+			if (!(b[i] & 0x80)) {
+				b += i + 1;
+				return true;
+			}
+		}
+
+		return false;
+	} else if constexpr (is_optional<T>::value) {
+		if (!remaining) {
+			return false;
+		}
+
+		bool isValuePresent = *b++ != 0;
+		return !isValuePresent || validateBuf<typename T::value_type>(b, remaining - 1, lens);
+	} else if constexpr (is_tuple<T>::value || is_std_array<T>::value) {
+		if constexpr (is_tuple_arithmetic<T>::value) {
+			if (remaining < is_tuple_arithmetic<T>::size) {
+				return false;
+			}
+
+			b += is_tuple_arithmetic<T>::size;
+			return true;
+		} else if constexpr (is_std_array<T>::value && std::is_arithmetic<std::tuple_element_t<0, T>>::value) {
+			constexpr sz_t size = sizeof(std::tuple_element_t<0, T>) * std::tuple_size<T>::value;
+			if (remaining < size) {
+				return false;
+			}
+
+			b += size;
+			return true;
+		} else {
+			return [&] <std::size_t... Is> (std::index_sequence<Is...>) {
+				return (validateBuf<typename std::tuple_element<Is, T>::type>(b, remaining - (b - start), lens) && ...);
+			}(std::make_index_sequence<std::tuple_size<T>::value>{});
+		}
+	} else { // containers
+		using V = typename T::value_type;
+
+		u64 size;
+		if (!validateLength(b, remaining, size, lens)) {
+			return false;
+		}
+
+		remaining -= b - start;
+
+		if constexpr (std::is_arithmetic<V>::value) {
+			if (size > remaining / sizeof(V)) {
+				return false;
+			}
+
+			b += size * sizeof(V);
+			return true;
+		} else if constexpr (is_tuple_arithmetic<V>::value) {
+			if (size > remaining / is_tuple_arithmetic<V>::size) {
+				return false;
+			}
+
+			b += size * is_tuple_arithmetic<V>::size;
+			return true;
+		} else {
+			if (size > remaining) { /* size of the elements will be 1 at least */
+				return false;
+			}
+
+			const u8 * elems = b;
+			while (size-- > 0) {
+				if (!validateBuf<V>(b, remaining - (b - elems), lens)) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+	}
+}
+
+template<typename... Args>
+bool validateArgs(const u8 * b, sz_t size, Lengths& lens) {
+	const u8 * start = b;
+	lens.clear();
+
+	if constexpr (are_all_arithmetic<Args...>::value) {
+		return add(sizeof(Args)...) == size;
+	} else {
+		return (validateBuf<Args>(b, size - (b - start), lens) && ...);
+	}
+}
+
+// readFromBuf without the checks, for buffers validateBuf accepted with the same lens
+template<typename T>
+T extract(const u8 *& b, Lengths& lens) {
+	if constexpr (std::is_arithmetic<T>::value) {
+		const u8 * readAt = b;
+		b += sizeof(T);
+		return buf::readBE<T>(readAt);
+	} else if constexpr (std::is_same_v<T, uvar> || std::is_same_v<T, ivar>) {
+		// same as the varints.cpp decoders, without the length checks and errno
+		u64 v = 0;
+		u32 shift = 0;
+		u8 byte;
+		do {
+			byte = *b++;
+			v |= static_cast<u64>(byte & 0x7F) << shift;
+			shift += 7;
+		} while (byte & 0x80);
+
+		if constexpr (std::is_signed_v<typename T::value_type>) {
+			i64 sv = static_cast<i64>(v >> 1);
+			return T{(v & 1) ? ~sv : sv};
+		} else {
+			return T{v};
+		}
+	} else if constexpr (is_optional<T>::value) {
+		if (*b++ == 0) {
+			return std::nullopt;
+		}
+
+		return extract<typename T::value_type>(b, lens);
+	} else if constexpr (is_tuple_arithmetic<T>::value) {
+		const u8 * readAt = b;
+		b += is_tuple_arithmetic<T>::size;
+		return readPacked<T>(readAt);
+	} else if constexpr (is_tuple<T>::value || is_std_array<T>::value) {
+		if constexpr (is_std_array<T>::value && std::is_arithmetic<std::tuple_element_t<0, T>>::value) {
+			T arr;
+			buf::readBEArray(arr.data(), b, arr.size());
+			b += sizeof(typename T::value_type) * arr.size();
+			return arr;
+		} else {
+			// braced init runs the extracts left to right
+			return [&] <std::size_t... Is> (std::index_sequence<Is...>) {
+				return T{extract<typename std::tuple_element<Is, T>::type>(b, lens)...};
+			}(std::make_index_sequence<std::tuple_size<T>::value>{});
+		}
+	} else { // containers
+		using V = typename T::value_type;
+
+		auto [size, prefixBytes] = lens.pop();
+		b += prefixBytes;
+
+		T c;
+		if constexpr (std::is_arithmetic<V>::value && requires { c.data(); }) {
+			c.resize(size);
+			buf::readBEArray(c.data(), b, size);
+			b += size * sizeof(V);
+		} else if constexpr (std::is_arithmetic<V>::value) {
+			c.reserve(size);
+			for (u64 i = 0; i < size; i++) {
+				c.push_back(buf::readBE<V>(b));
+				b += sizeof(V);
+			}
+		} else if constexpr (is_tuple_arithmetic<V>::value) {
+			c.reserve(size);
+			readPackedArray<V>(b, size, [&c] (auto... fields) {
+				c.emplace_back(fields...);
+			});
+
+			b += size * is_tuple_arithmetic<V>::size;
+		} else {
+			c.reserve(size);
+			for (u64 i = 0; i < size; i++) {
+				c.emplace_back(extract<V>(b, lens));
+			}
+		}
+
+		return c;
+	}
+}
+
 } // namespace pktdetail
 
 template<u8 opCode, typename... Args>
@@ -437,6 +771,24 @@ std::tuple<Args...> Packet<opCode, Args...>::fromBuffer(const u8 * buffer, sz_t
 	return std::tuple<Args...>{readFromBuf<Args>(buffer, size - (buffer - start))...};
 }
 
+template<u8 opCode, typename... Args>
+bool Packet<opCode, Args...>::validate(const u8 * buffer, sz_t size) {
+	return pktdetail::validateArgs<Args...>(buffer, size, pktdetail::scratchLengths());
+}
+
+template<u8 opCode, typename... Args>
+std::optional<std::tuple<Args...>> Packet<opCode, Args...>::tryFromBuffer(const u8 * buffer, sz_t size) {
+	using namespace pktdetail;
+	Lengths& lens = scratchLengths();
+
+	if (!validateArgs<Args...>(buffer, size, lens)) {
+		return std::nullopt;
+	}
+
+	// the checks were all done by the validation, this pass only builds the values
+	return std::tuple<Args...>{extract<Args>(buffer, lens)...};
+}
+
 template<u8 opCode, typename... Args>
 std::tuple<std::unique_ptr<u8[]>, sz_t> Packet<opCode, Args...>::toBuffer(const Args&... args) {
 	using namespace pktdetail;
@@ -1,15 +1,33 @@
 #include "util/net/PacketReader.hpp"
 
-PacketReader::PacketReader() { }
+#include <cstdio>
+
+PacketReader::PacketReader()
+: droppedMessages(0) { }
 
 bool PacketReader::read(const u8 * buf, sz_t size) {
+	if (size == 0) {
+		++droppedMessages;
+		std::fprintf(stderr, "[PacketReader] Dropped empty message (%zu dropped)\n", droppedMessages);
+		return true;
+	}
+
 	OpCode opc(buf[0]);
 	auto search = handlers.find(opc);
 	
 	if (search != handlers.end()) {
-		search->second(buf + 1, size - 1);
+		if (!search->second(buf + 1, size - 1)) {
+			++droppedMessages;
+			std::fprintf(stderr, "[PacketReader] Dropped malformed message, opcode: %u, size: %zu (%zu dropped)\n",
+					opc, size, droppedMessages);
+		}
+
 		return true;
 	}
 
 	return false;
 }
+
+sz_t PacketReader::getDroppedCount() const {
+	return droppedMessages;
+}
@@ -7,12 +7,16 @@
 
 class PacketReader {
 	using OpCode = u8;
-	std::unordered_map<OpCode, std::function<void(const u8 *, sz_t)>> handlers;
+	// handlers return false if the message was malformed
+	std::unordered_map<OpCode, std::function<bool(const u8 *, sz_t)>> handlers;
+	sz_t droppedMessages;
 
 public:
 	PacketReader();
 
+	// returns false if no handler was found for the opcode
 	bool read(const u8 *, sz_t);
+	sz_t getDroppedCount() const;
 
 	template<typename Packet, typename Func>
 	requires std::is_same_v<typename Packet::value_type, typename fromBufFromLambdaArgs<Func>::value_type>
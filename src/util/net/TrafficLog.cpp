@@ -0,0 +1,126 @@
+#include "util/net/TrafficLog.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+#include "util/varints.hpp"
+
+static constexpr sz_t headerSize = sizeof(TrafficLog::magic) + sizeof(TrafficLog::version);
+
+TrafficLog::TrafficLog(sz_t nMaxBytes)
+: lastTs(-1.0),
+  frames(0),
+  maxBytes(nMaxBytes) {
+	clear();
+}
+
+void TrafficLog::clear() {
+	std::vector<u8>().swap(buf); // also gives back the memory of the last log
+	buf.insert(buf.end(), std::begin(magic), std::end(magic));
+	buf.push_back(version);
+	lastTs = -1.0;
+	frames = 0;
+}
+
+bool TrafficLog::append(Direction dir, double tsMs, const u8 * data, sz_t size) {
+	// first frame is the time origin
+	u64 dtUs = lastTs < 0.0 ? 0 : static_cast<u64>(std::max(0.0, tsMs - lastTs) * 1000.0);
+
+	sz_t pos = buf.size();
+	sz_t needed = pos + 1 + unsignedVarintSize(dtUs) + unsignedVarintSize(size) + size;
+	if (needed > maxBytes) {
+		return false;
+	}
+
+	// never let the doubling go past the cap
+	if (needed > buf.capacity()) {
+		buf.reserve(std::min(std::max(needed, buf.capacity() * 2), maxBytes));
+	}
+
+	lastTs = tsMs;
+	buf.resize(needed);
+	u8 * p = buf.data() + pos;
+
+	*p++ = dir;
+	p += encodeUnsignedVarint(p, dtUs);
+	p += encodeUnsignedVarint(p, size);
+	if (size) {
+		std::memcpy(p, data, size);
+	}
+
+	++frames;
+	return true;
+}
+
+const std::vector<u8>& TrafficLog::get() const {
+	return buf;
+}
+
+sz_t TrafficLog::getFrameCount() const {
+	return frames;
+}
+
+sz_t TrafficLog::getMaxBytes() const {
+	return maxBytes;
+}
+
+void TrafficLog::setMaxBytes(sz_t n) {
+	maxBytes = n;
+}
+
+TrafficLog::Reader::Reader(const u8 * data, sz_t size)
+: cur(data + headerSize),
+  end(data + size),
+  ts(0.0),
+  valid(size >= headerSize
+		&& std::memcmp(data, magic, sizeof(magic)) == 0
+		&& data[sizeof(magic)] == version) {
+	if (!valid) {
+		cur = end;
+	}
+}
+
+bool TrafficLog::Reader::ok() const {
+	return valid;
+}
+
+bool TrafficLog::Reader::next(Frame& f) {
+	if (cur == end) {
+		return false;
+	}
+
+	sz_t read = 0;
+	Direction dir = static_cast<Direction>(*cur++);
+	if (dir != D_IN && dir != D_OUT) {
+		valid = false;
+		cur = end;
+		return false;
+	}
+
+	u64 dtUs = decodeUnsignedVarint(cur, read, end - cur);
+	if (read == 0) {
+		valid = false;
+		cur = end;
+		return false;
+	}
+
+	cur += read;
+	read = 0;
+	u64 size = decodeUnsignedVarint(cur, read, end - cur);
+	if (read == 0 || size > static_cast<u64>(end - cur - read)) {
+		valid = false;
+		cur = end;
+		return false;
+	}
+
+	cur += read;
+	ts += dtUs / 1000.0;
+
+	f.dir = dir;
+	f.ts = ts;
+	f.data = cur;
+	f.size = size;
+
+	cur += size;
+	return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+#include "util/explints.hpp"
+
+// compact binary capture of websocket frames, layout:
+// header: "OWRL" u8 version
+// frame:  u8 direction, uvar µs since previous frame, uvar length, payload
+class TrafficLog {
+public:
+	enum Direction : u8 { D_IN, D_OUT };
+
+	struct Frame {
+		Direction dir;
+		double ts; // ms since the first frame
+		const u8 * data;
+		sz_t size;
+	};
+
+	class Reader {
+		const u8 * cur;
+		const u8 * end;
+		double ts;
+		bool valid;
+
+	public:
+		Reader(const u8 *, sz_t);
+
+		// false if the header was wrong or a frame was truncated
+		bool ok() const;
+		bool next(Frame&);
+	};
+
+	static constexpr u8 magic[4] = {'O', 'W', 'R', 'L'};
+	static constexpr u8 version = 1;
+	// the heap doesn't grow, a log left running in a busy world would eat all of it
+	static constexpr sz_t defaultMaxBytes = 1024 * 1024;
+
+private:
+	std::vector<u8> buf;
+	double lastTs;
+	sz_t frames;
+	sz_t maxBytes;
+
+public:
+	TrafficLog(sz_t maxBytes = defaultMaxBytes);
+
+	void clear();
+	// false if the frame would go over maxBytes, the log is left as it was
+	bool append(Direction, double tsMs, const u8 *, sz_t);
+
+	const std::vector<u8>& get() const;
+	sz_t getFrameCount() const;
+	sz_t getMaxBytes() const;
+	void setMaxBytes(sz_t); // only for the next clear()
+};
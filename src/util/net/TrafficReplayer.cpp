@@ -0,0 +1,157 @@
+#include "util/net/TrafficReplayer.hpp"
+
+#include <cstdio>
+#include <algorithm>
+
+#include <malloc.h>
+#include <emscripten.h>
+#include <emscripten/html5.h>
+
+static sz_t heapInUse() {
+	return mallinfo().uordblks;
+}
+
+TrafficLogSource::TrafficLogSource(std::vector<u8> nLog)
+: log(std::move(nLog)),
+  reader(this->log.data(), this->log.size()) { }
+
+bool TrafficLogSource::next(TrafficLog::Frame& f) {
+	return reader.next(f);
+}
+
+bool TrafficLogSource::ok() const {
+	return reader.ok();
+}
+
+TrafficReplayer::TrafficReplayer(std::unique_ptr<TrafficSource> nSource, bool nRealtime,
+	std::function<void(const u8 *, sz_t)> nDeliver, std::function<void()> nOnFinish)
+: source(std::move(nSource)),
+  pending{},
+  deliver(std::move(nDeliver)),
+  onFinish(std::move(nOnFinish)),
+  stats{},
+  startTs(0.0),
+  handlingMs(0.0),
+  heapStart(0),
+  heapHighWater(0),
+  frames(0),
+  timer(0),
+  realtime(nRealtime),
+  hasPending(false),
+  finished(false) { }
+
+TrafficReplayer::~TrafficReplayer() {
+	if (timer) {
+		emscripten_clear_timeout(timer);
+	}
+}
+
+bool TrafficReplayer::start() {
+	if (!source->ok()) {
+		std::fprintf(stderr, "[TrafficReplayer] Invalid traffic source\n");
+		return false;
+	}
+
+	std::printf("[TrafficReplayer] Replaying (%s)\n", realtime ? "real time" : "fast");
+	heapStart = heapHighWater = heapInUse();
+	startTs = emscripten_get_now();
+	step();
+	return true;
+}
+
+bool TrafficReplayer::isFinished() const {
+	return finished;
+}
+
+const TrafficReplayer::OpStats& TrafficReplayer::getStats(u8 opCode) const {
+	return stats[opCode];
+}
+
+void TrafficReplayer::printReport() const {
+	double wallMs = emscripten_get_now() - startTs;
+	std::printf("[TrafficReplayer] %zu frames, wall %.2fms, handling %.2fms (%.0f msgs/s)\n",
+		frames, wallMs, handlingMs, handlingMs > 0.0 ? frames / (handlingMs / 1000.0) : 0.0);
+
+	for (sz_t op = 0; op < stats.size(); op++) {
+		const OpStats& s = stats[op];
+		if (s.count == 0) {
+			continue;
+		}
+
+		std::printf("[TrafficReplayer]  op %3zu: %6u msgs, total %9.3fms, avg %8.2fus, max %8.2fus, heap +%zuB\n",
+			op, s.count, s.totalMs, s.totalMs * 1000.0 / s.count, s.maxMs * 1000.0, s.heapGrowth);
+	}
+
+	std::printf("[TrafficReplayer] Heap: start %zuB, high-water %zuB\n", heapStart, heapHighWater);
+	if (!source->ok()) {
+		std::printf("[TrafficReplayer] Source was truncated or corrupt, replay stopped early\n");
+	}
+}
+
+void TrafficReplayer::step() {
+	timer = 0;
+	if (hasPending) {
+		hasPending = false;
+		handle(pending);
+	}
+
+	TrafficLog::Frame f;
+	while (source->next(f)) {
+		if (f.dir != TrafficLog::D_IN) {
+			continue; // we don't resend what the client sent
+		}
+
+		if (realtime) {
+			double due = startTs + f.ts - emscripten_get_now();
+			if (due > 0.0) {
+				pending = f;
+				hasPending = true;
+				timer = emscripten_set_timeout(TrafficReplayer::doStep, due, this);
+				return;
+			}
+		}
+
+		handle(f);
+	}
+
+	finish();
+}
+
+void TrafficReplayer::handle(const TrafficLog::Frame& f) {
+	if (f.size == 0) {
+		deliver(f.data, f.size);
+		return;
+	}
+
+	OpStats& s = stats[f.data[0]];
+	sz_t heapBefore = heapInUse();
+	double t = emscripten_get_now();
+
+	deliver(f.data, f.size);
+
+	double took = emscripten_get_now() - t;
+	sz_t heapAfter = heapInUse();
+
+	++s.count;
+	s.totalMs += took;
+	s.maxMs = std::max(s.maxMs, took);
+	if (heapAfter > heapBefore) {
+		s.heapGrowth += heapAfter - heapBefore;
+	}
+
+	heapHighWater = std::max(heapHighWater, heapAfter);
+	handlingMs += took;
+	++frames;
+}
+
+void TrafficReplayer::finish() {
+	finished = true;
+	printReport();
+	if (onFinish) {
+		onFinish();
+	}
+}
+
+void TrafficReplayer::doStep(void * d) {
+	static_cast<TrafficReplayer *>(d)->step();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <functional>
+
+#include "util/NonCopyable.hpp"
+#include "util/explints.hpp"
+#include "util/net/TrafficLog.hpp"
+
+class TrafficSource {
+public:
+	virtual ~TrafficSource() = default;
+
+	// frame data must stay valid until the next call
+	virtual bool next(TrafficLog::Frame&) = 0;
+	// false if the source stopped because of bad data
+	virtual bool ok() const = 0;
+};
+
+class TrafficLogSource : public TrafficSource {
+	std::vector<u8> log;
+	TrafficLog::Reader reader;
+
+public:
+	TrafficLogSource(std::vector<u8> log);
+
+	bool next(TrafficLog::Frame&) override;
+	bool ok() const override;
+};
+
+// feeds the inbound frames of a TrafficSource into a handler, either all at
+// once or paced like they were recorded, and keeps per opcode timings
+class TrafficReplayer : NonCopyable {
+public:
+	struct OpStats {
+		u32 count;
+		double totalMs;
+		double maxMs;
+		sz_t heapGrowth; // sum of positive heap deltas while handling
+	};
+
+private:
+	std::unique_ptr<TrafficSource> source;
+	TrafficLog::Frame pending;
+	std::function<void(const u8 *, sz_t)> deliver;
+	std::function<void()> onFinish;
+	std::array<OpStats, 256> stats;
+	double startTs;
+	double handlingMs;
+	sz_t heapStart;
+	sz_t heapHighWater;
+	sz_t frames;
+	long timer;
+	bool realtime;
+	bool hasPending;
+	bool finished;
+
+public:
+	// onFinish is called once the log runs out, the replayer must outlive the call
+	TrafficReplayer(std::unique_ptr<TrafficSource>, bool realtime,
+		std::function<void(const u8 *, sz_t)> deliver, std::function<void()> onFinish);
+	~TrafficReplayer();
+
+	// false if the source is unusable from the start
+	bool start();
+	bool isFinished() const;
+
+	const OpStats& getStats(u8 opCode) const;
+	void printReport() const;
+
+private:
+	void step();
+	void handle(const TrafficLog::Frame&);
+	void finish();
+
+	static void doStep(void *);
+};
@@ -59,6 +59,18 @@ bool Chunk::setPixel(u16 pxX, u16 pxY, RGB_u clr, bool alphaBlending) {
 	return true;
 }
 
+bool Chunk::setPixels(const ChunkGlState::PxUpdate * px, sz_t n, bool alphaBlending) {
+	if (n == 0) {
+		return false;
+	}
+
+	preventUnloading(true);
+	glst.queueSetPixels(px, n, alphaBlending);
+	w.signalChunkUpdated(this);
+	preventUnloading(false);
+	return true;
+}
+
 RGB_u Chunk::getPixel(u16 pxX, u16 pxY) const {
 	pxX &= Chunk::size - 1;
 	pxY &= Chunk::size - 1;
@@ -106,6 +118,7 @@ bool Chunk::tryLoad() {
 	preventUnloading(true);
 
 	glst.loading();
+	w.signalChunkStateChanged(this);
 	// terrible use of unique_ptr. 1 + needed because request id can be 0
 	loaderRequest.reset(reinterpret_cast<void *>(1 + async_request(
 			w.getChunkUrl(x, y), "GET", nullptr, this, true,
@@ -115,6 +128,22 @@ bool Chunk::tryLoad() {
 	return true;
 }
 
+bool Chunk::loadImage(PngImage&& img) {
+	preventUnloading(true);
+	loaderRequest = nullptr;
+	protectionData.fill(0);
+
+	bool ok = glst.loadTextures(w.getRenderer().getChunkTexPool(), std::move(img), protectionData);
+	if (!ok) {
+		glst.loadError();
+	}
+
+	numErrors = 0;
+	w.signalChunkLoaded(this);
+	preventUnloading(false);
+	return ok;
+}
+
 bool Chunk::isLoading() const {
 	return loaderRequest != nullptr;
 }
@@ -160,7 +189,7 @@ void Chunk::loadCompleted(unsigned, void * e, void * buf, unsigned len) {
 			c.protectionData.fill(0);
 		}
 
-		if (!c.glst.loadTextures(std::move(data), c.protectionData)) {
+		if (!c.glst.loadTextures(c.w.getRenderer().getChunkTexPool(), std::move(data), c.protectionData)) {
 			c.glst.loadError();
 			loadStatus = 1;
 		}
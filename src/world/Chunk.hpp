@@ -34,6 +34,8 @@ public:
 	twoi32 getUpdArea() const;
 
 	bool setPixel(u16 x, u16 y, RGB_u, bool alphaBlending);
+	// many pixels with one renderer signal, positions must be chunk-local already
+	bool setPixels(const ChunkGlState::PxUpdate *, sz_t n, bool alphaBlending);
 	RGB_u getPixel(u16 x, u16 y) const;
 
 	const u8 * getData() const;
@@ -42,6 +44,8 @@ public:
 	ProtGid getProtectionGid(ProtPos x, ProtPos y) const;
 
 	bool tryLoad();
+	// replaces the contents, cancelling any pending load
+	bool loadImage(PngImage&&);
 	bool isLoading() const;
 	bool isReady() const;
 	bool shouldUnload() const;
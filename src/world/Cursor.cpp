@@ -1,6 +1,6 @@
 #include "world/Cursor.hpp"
 
-#include "world/World.hpp"
+#include "world/WorldConstants.hpp"
 #include "util/emsc/time.hpp"
 
 #include <cmath>
@@ -54,7 +54,7 @@ WorldPos Cursor::getY() const {
 }
 
 twoi32 Cursor::getUpdArea() const {
-	return World::updAreaOf(x, y);
+	return WorldConstants::updAreaOf(x, y);
 }
 
 Cursor::Step Cursor::getStep() const {
@@ -63,7 +63,7 @@ Cursor::Step Cursor::getStep() const {
 
 float Cursor::getPosLerpTime() const {
 	std::chrono::duration<float, std::milli> elapsed = getStClock() - lastUpdate;
-	return std::min(elapsed.count() / World::updateRateMs, 1.f);
+	return std::min(elapsed.count() / WorldConstants::updateRateMs, 1.f);
 }
 
 float Cursor::getSmoothX() const {
@@ -0,0 +1,403 @@
+#include "world/CursorStore.hpp"
+
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+#include "tools/ToolManager.hpp"
+#include "util/emsc/time.hpp"
+#include "world/WorldConstants.hpp"
+
+static float stepOffX(Cursor::Step st) {
+	return (st & 0xF) / 15.f;
+}
+
+static float stepOffY(Cursor::Step st) {
+	return (st >> 4 & 0xF) / 15.f;
+}
+
+// velocity estimation, per update
+static constexpr float velSmoothing = 0.5f; // weight of the newest sample
+static constexpr float maxSampleGap = WorldConstants::updateRateMs * 4.f / 1000.f; // s, longer means it was idle
+static constexpr float maxSampleJump = 256.f; // px, teleports don't give a velocity
+static constexpr float updateInterval = WorldConstants::updateRateMs / 1000.f; // s
+
+CursorStore::CursorStore()
+: horizon(WorldConstants::updateRateMs / 1000.f),
+  latency(0.f) { }
+
+sz_t CursorStore::size() const {
+	return ids.size();
+}
+
+bool CursorStore::empty() const {
+	return ids.empty();
+}
+
+void CursorStore::reserve(sz_t n) {
+	ids.reserve(n);
+	users.reserve(n);
+	xs.reserve(n);
+	ys.reserve(n);
+	steps.reserve(n);
+	smoothXs.reserve(n);
+	smoothYs.reserve(n);
+	finalXs.reserve(n);
+	finalYs.reserve(n);
+	velXs.reserve(n);
+	velYs.reserve(n);
+	drawXs.reserve(n);
+	drawYs.reserve(n);
+	lastUpdates.reserve(n);
+	toolStates.reserve(n);
+	areaIdxs.reserve(n);
+	slots.reserve(n);
+}
+
+void CursorStore::clear() {
+	ids.clear();
+	users.clear();
+	xs.clear();
+	ys.clear();
+	steps.clear();
+	smoothXs.clear();
+	smoothYs.clear();
+	finalXs.clear();
+	finalYs.clear();
+	velXs.clear();
+	velYs.clear();
+	drawXs.clear();
+	drawYs.clear();
+	lastUpdates.clear();
+	toolStates.clear();
+	areaIdxs.clear();
+	slots.clear();
+	byArea.clear();
+}
+
+CursorStore::Slot CursorStore::find(Id id) const {
+	auto it = slots.find(id);
+	return it != slots.end() ? it->second : npos;
+}
+
+CursorStore::Slot CursorStore::insert(User& usr, Id id, WorldPos x, WorldPos y, Step st, ToolManager& tm, Tid tid, Tstate tstate) {
+	Slot s = ids.size();
+	auto [it, inserted] = slots.emplace(id, s);
+	assert((inserted && "cursor id already in store!"));
+
+	ids.emplace_back(id);
+	users.emplace_back(&usr);
+	xs.emplace_back(x);
+	ys.emplace_back(y);
+	steps.emplace_back(st);
+	smoothXs.emplace_back(x + stepOffX(st));
+	smoothYs.emplace_back(y + stepOffY(st));
+	finalXs.emplace_back(smoothXs.back());
+	finalYs.emplace_back(smoothYs.back());
+	velXs.emplace_back(0.f);
+	velYs.emplace_back(0.f);
+	drawXs.emplace_back(smoothXs.back());
+	drawYs.emplace_back(smoothYs.back());
+	lastUpdates.emplace_back(getTime());
+	toolStates.emplace_back(tid);
+	tm.updateState(toolStates.back(), tid, tstate);
+	areaIdxs.emplace_back(0);
+	areaAdd(s, getUpdArea(s));
+
+	return s;
+}
+
+void CursorStore::remove(Slot s) {
+	assert(s < ids.size());
+	Slot last = ids.size() - 1;
+	slots.erase(ids[s]);
+	areaRemove(s, getUpdArea(s));
+
+	if (s != last) {
+		ids[s] = ids[last];
+		users[s] = users[last];
+		xs[s] = xs[last];
+		ys[s] = ys[last];
+		steps[s] = steps[last];
+		smoothXs[s] = smoothXs[last];
+		smoothYs[s] = smoothYs[last];
+		finalXs[s] = finalXs[last];
+		finalYs[s] = finalYs[last];
+		velXs[s] = velXs[last];
+		velYs[s] = velYs[last];
+		drawXs[s] = drawXs[last];
+		drawYs[s] = drawYs[last];
+		lastUpdates[s] = lastUpdates[last];
+		toolStates[s] = std::move(toolStates[last]);
+		areaIdxs[s] = areaIdxs[last];
+		slots[ids[s]] = s;
+		byArea.find(getUpdArea(s))->second[areaIdxs[s]] = s;
+	}
+
+	ids.pop_back();
+	users.pop_back();
+	xs.pop_back();
+	ys.pop_back();
+	steps.pop_back();
+	smoothXs.pop_back();
+	smoothYs.pop_back();
+	finalXs.pop_back();
+	finalYs.pop_back();
+	velXs.pop_back();
+	velYs.pop_back();
+	drawXs.pop_back();
+	drawYs.pop_back();
+	lastUpdates.pop_back();
+	toolStates.pop_back();
+	areaIdxs.pop_back();
+}
+
+sz_t CursorStore::removeArea(twoi32 area) {
+	sz_t removed = 0;
+	// areaRemove drops the entry along with the last cursor
+	for (auto it = byArea.find(area); it != byArea.end(); it = byArea.find(area)) {
+		remove(it->second.back());
+		++removed;
+	}
+
+	return removed;
+}
+
+sz_t CursorStore::queryRect(float tlx, float tly, float brx, float bry, std::vector<Slot>& out) const {
+	sz_t before = out.size();
+	const float uaSz = WorldConstants::updateAreaSize;
+	// cursors are indexed by their last update, but drawn where they are animating from,
+	// which can still be in the neighbouring area after crossing, so look one area further
+	i64 tlax = std::floor(tlx / uaSz) - 1;
+	i64 tlay = std::floor(tly / uaSz) - 1;
+	i64 brax = std::floor(brx / uaSz) + 1;
+	i64 bray = std::floor(bry / uaSz) + 1;
+
+	auto visit = [&] (const std::vector<Slot>& area) {
+		for (Slot s : area) {
+			float x = drawXs[s];
+			float y = drawYs[s];
+			if (x >= tlx && x <= brx && y >= tly && y <= bry) {
+				out.emplace_back(s);
+			}
+		}
+	};
+
+	// zoomed far out the rect can span more areas than we have cursors in
+	if (static_cast<u64>(brax - tlax + 1) * static_cast<u64>(bray - tlay + 1) <= byArea.size()) {
+		for (i64 y = tlay; y <= bray; y++) {
+			for (i64 x = tlax; x <= brax; x++) {
+				auto it = byArea.find(mk_twoi32(x, y));
+				if (it != byArea.end()) {
+					visit(it->second);
+				}
+			}
+		}
+	} else {
+		for (const auto& [a, area] : byArea) {
+			if (a.c.x >= tlax && a.c.x <= brax && a.c.y >= tlay && a.c.y <= bray) {
+				visit(area);
+			}
+		}
+	}
+
+	return out.size() - before;
+}
+
+sz_t CursorStore::getAreaCount() const {
+	return byArea.size();
+}
+
+CursorStore::Id CursorStore::getId(Slot s) const {
+	return ids[s];
+}
+
+User& CursorStore::getUser(Slot s) const {
+	return *users[s];
+}
+
+WorldPos CursorStore::getX(Slot s) const {
+	return xs[s];
+}
+
+WorldPos CursorStore::getY(Slot s) const {
+	return ys[s];
+}
+
+CursorStore::Step CursorStore::getStep(Slot s) const {
+	return steps[s];
+}
+
+twoi32 CursorStore::getUpdArea(Slot s) const {
+	return WorldConstants::updAreaOf(xs[s], ys[s]);
+}
+
+float CursorStore::getPosLerpTime(Slot s) const {
+	float elapsedMs = (getTime() - lastUpdates[s]) * 1000.0;
+	return std::min(elapsedMs / WorldConstants::updateRateMs, 1.f);
+}
+
+float CursorStore::getSmoothX(Slot s) const {
+	float e = getTime() - lastUpdates[s];
+	float target = finalXs[s] + velXs[s] * getLead(e);
+	return std::lerp(smoothXs[s], target, getPosLerpTime(s));
+}
+
+float CursorStore::getSmoothY(Slot s) const {
+	float e = getTime() - lastUpdates[s];
+	float target = finalYs[s] + velYs[s] * getLead(e);
+	return std::lerp(smoothYs[s], target, getPosLerpTime(s));
+}
+
+float CursorStore::getFinalX(Slot s) const {
+	return finalXs[s];
+}
+
+float CursorStore::getFinalY(Slot s) const {
+	return finalYs[s];
+}
+
+void CursorStore::setPredictionHorizon(float ms) {
+	horizon = std::max(ms, 0.f) / 1000.f;
+}
+
+float CursorStore::getPredictionHorizon() const {
+	return horizon * 1000.f;
+}
+
+void CursorStore::setLatency(float ms) {
+	latency = std::max(ms, 0.f) / 1000.f;
+}
+
+float CursorStore::getLatency() const {
+	return latency * 1000.f;
+}
+
+bool CursorStore::interpolate(double now) {
+	// same as getSmoothX/Y for every slot, but branchless over plain arrays so it vectorizes.
+	// the target keeps moving at the estimated velocity for up to the horizon, and the drawn
+	// position blends from where it was at the last update into it, which hides the correction.
+	// with no update for long after that the player stopped, and the lead fades out
+	const float rate = 1000.f / WorldConstants::updateRateMs;
+	const float hz = horizon;
+	const float lead = hz > 0.f ? latency : 0.f;
+	const float stale = updateInterval + hz;
+	const sz_t n = ids.size();
+	const double * lu = lastUpdates.data();
+	const float * sx = smoothXs.data();
+	const float * sy = smoothYs.data();
+	const float * fx = finalXs.data();
+	const float * fy = finalYs.data();
+	const float * vx = velXs.data();
+	const float * vy = velYs.data();
+	float * dx = drawXs.data();
+	float * dy = drawYs.data();
+	u32 animating = 0;
+
+	for (sz_t i = 0; i < n; i++) {
+		float e = static_cast<float>(now - lu[i]);
+		float t = std::min(e * rate, 1.f);
+		float fade = std::clamp(1.f - (e - stale) * rate, 0.f, 1.f);
+		float pe = (std::min(e, hz) + lead) * fade;
+		float tx = fx[i] + vx[i] * pe;
+		float ty = fy[i] + vy[i] * pe;
+		dx[i] = sx[i] + (tx - sx[i]) * t;
+		dy[i] = sy[i] + (ty - sy[i]) * t;
+		animating |= (t < 1.f) | ((e < stale + updateInterval) & ((vx[i] != 0.f) | (vy[i] != 0.f)));
+	}
+
+	return animating;
+}
+
+float CursorStore::getDrawX(Slot s) const {
+	return drawXs[s];
+}
+
+float CursorStore::getDrawY(Slot s) const {
+	return drawYs[s];
+}
+
+const ToolStates& CursorStore::getToolStates(Slot s) const {
+	return toolStates[s];
+}
+
+ToolStates& CursorStore::getToolStates(Slot s) {
+	return toolStates[s];
+}
+
+bool CursorStore::updateRel(Slot s, WorldPos relX, WorldPos relY, Step st, ToolManager& tm, Tid tid, Tstate tstate) {
+	return update(s, xs[s] + relX, ys[s] + relY, st, tm, tid, tstate);
+}
+
+bool CursorStore::update(Slot s, WorldPos x, WorldPos y, Step st, ToolManager& tm, Tid tid, Tstate tstate) {
+	bool updated = false;
+	updated |= setPos(s, x, y, st);
+	updated |= tm.updateState(toolStates[s], tid, tstate);
+	return updated;
+}
+
+bool CursorStore::setPos(Slot s, WorldPos x, WorldPos y, Step st) {
+	smoothXs[s] = getSmoothX(s);
+	smoothYs[s] = getSmoothY(s);
+
+	float dt = getTime() - lastUpdates[s];
+	float mx = x + stepOffX(st) - finalXs[s];
+	float my = y + stepOffY(st) - finalYs[s];
+	if ((mx == 0.f && my == 0.f) || dt > maxSampleGap
+			|| std::abs(mx) > maxSampleJump || std::abs(my) > maxSampleJump) {
+		// stopped, was idle or teleported
+		velXs[s] = 0.f;
+		velYs[s] = 0.f;
+	} else if (dt > 0.f) { // more than one update in a frame just moves the target
+		velXs[s] += (mx / dt - velXs[s]) * velSmoothing;
+		velYs[s] += (my / dt - velYs[s]) * velSmoothing;
+	}
+
+	lastUpdates[s] = getTime();
+
+	bool updated = xs[s] != x || ys[s] != y || steps[s] != st;
+	twoi32 oldArea = getUpdArea(s);
+	xs[s] = x;
+	ys[s] = y;
+	steps[s] = st;
+	finalXs[s] = x + stepOffX(st);
+	finalYs[s] = y + stepOffY(st);
+
+	twoi32 newArea = getUpdArea(s);
+	if (newArea != oldArea) {
+		areaRemove(s, oldArea);
+		areaAdd(s, newArea);
+	}
+
+	return updated;
+}
+
+// seconds to extrapolate for, elapsed since the update arrived
+float CursorStore::getLead(float elapsed) const {
+	if (horizon <= 0.f) {
+		return 0.f;
+	}
+
+	float fade = std::clamp(1.f - (elapsed - updateInterval - horizon) / updateInterval, 0.f, 1.f);
+	return (std::min(elapsed, horizon) + latency) * fade;
+}
+
+void CursorStore::areaAdd(Slot s, twoi32 area) {
+	auto& v = byArea[area];
+	areaIdxs[s] = v.size();
+	v.emplace_back(s);
+}
+
+void CursorStore::areaRemove(Slot s, twoi32 area) {
+	auto it = byArea.find(area);
+	assert(it != byArea.end());
+	auto& v = it->second;
+	Slot moved = v.back();
+	v[areaIdxs[s]] = moved;
+	areaIdxs[moved] = areaIdxs[s];
+	v.pop_back();
+	// queryRect compares byArea.size() against the rect's area count
+	if (v.empty()) {
+		byArea.erase(it);
+	}
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include "tools/ToolStates.hpp"
+#include "util/explints.hpp"
+#include "util/misc.hpp"
+#include "world/Cursor.hpp"
+
+class User;
+class ToolManager;
+
+// remote cursors, one array per field. slots are dense and unordered, removal
+// swaps the last cursor into the hole, so slot numbers change on remove().
+// cursors are also indexed by update area, kept in sync on every move.
+class CursorStore {
+public:
+	using Id = Cursor::Id;
+	using Tid = Cursor::Tid;
+	using Tstate = Cursor::Tstate;
+	using Step = Cursor::Step;
+	using Slot = u32;
+
+	static constexpr Slot npos = static_cast<Slot>(-1);
+
+private:
+	std::vector<Id> ids;
+	std::vector<User *> users;
+	std::vector<WorldPos> xs;
+	std::vector<WorldPos> ys;
+	std::vector<Step> steps;
+	std::vector<float> smoothXs; // interpolation start, where the cursor was drawn when it last updated
+	std::vector<float> smoothYs;
+	std::vector<float> finalXs; // interpolation end, pos + step offset
+	std::vector<float> finalYs;
+	std::vector<float> velXs; // estimated from the last updates, px/s
+	std::vector<float> velYs;
+	std::vector<float> drawXs; // written by interpolate()
+	std::vector<float> drawYs;
+	std::vector<double> lastUpdates; // getTime() seconds
+	std::vector<ToolStates> toolStates;
+	std::vector<u32> areaIdxs; // where each slot is in its byArea list
+	std::unordered_map<Id, Slot> slots;
+	std::unordered_map<twoi32, std::vector<Slot>> byArea;
+	float horizon; // seconds of extrapolation past the last update
+	float latency; // seconds updates spent on the way, the prediction starts from when they were sent
+
+public:
+	CursorStore();
+
+	sz_t size() const;
+	bool empty() const;
+	void reserve(sz_t);
+	void clear();
+
+	Slot find(Id) const;
+	// the id must not be in the store already
+	Slot insert(User&, Id, WorldPos, WorldPos, Step, ToolManager&, Tid, Tstate);
+	void remove(Slot);
+	// drops every cursor in the area, in time proportional to how many there are
+	sz_t removeArea(twoi32);
+	// appends the slots of cursors drawn inside the world rect to out, returns how many were added.
+	// a cursor that jumped more than an update area is missed until it gets there
+	sz_t queryRect(float tlx, float tly, float brx, float bry, std::vector<Slot>& out) const;
+	sz_t getAreaCount() const;
+
+	Id getId(Slot) const;
+	User& getUser(Slot) const;
+	WorldPos getX(Slot) const;
+	WorldPos getY(Slot) const;
+	Step getStep(Slot) const;
+	twoi32 getUpdArea(Slot) const;
+
+	float getPosLerpTime(Slot) const;
+	float getSmoothX(Slot) const;
+	float getSmoothY(Slot) const;
+	float getFinalX(Slot) const;
+	float getFinalY(Slot) const;
+
+	// how far ahead of the last update cursors keep moving at their estimated velocity.
+	// 0 just blends to the last known position. players that stop moving send nothing
+	// more, so if no update came for an update interval past the horizon, the cursor
+	// eases back to the last known position over one more interval
+	void setPredictionHorizon(float ms);
+	float getPredictionHorizon() const;
+	// how long updates take to arrive. with prediction on, cursors are extrapolated for that
+	// much longer, to where they are now rather than where they were when sent
+	void setLatency(float ms);
+	float getLatency() const;
+
+	// advances every cursor to the given getTime(), once per frame.
+	// returns true if any of them is still moving
+	bool interpolate(double now);
+	float getDrawX(Slot) const;
+	float getDrawY(Slot) const;
+
+	const ToolStates& getToolStates(Slot) const;
+	ToolStates& getToolStates(Slot);
+
+	bool updateRel(Slot, WorldPos relX, WorldPos relY, Step, ToolManager&, Tid, Tstate);
+	bool update(Slot, WorldPos absX, WorldPos absY, Step, ToolManager&, Tid, Tstate);
+	bool setPos(Slot, WorldPos, WorldPos, Step);
+
+private:
+	float getLead(float elapsed) const;
+	void areaAdd(Slot, twoi32);
+	void areaRemove(Slot, twoi32);
+};
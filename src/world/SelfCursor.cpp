@@ -51,9 +51,9 @@ bool SelfCursor::update(
 ) {
 
 	bool updated = false;
-	// this may not be optimal since the timestamp is not synchronized
-	actionLimiter.set(nActionBkt.getRate(), nActionBkt.getPer(), nActionBkt.getAllowance());
-	chatLimiter.set(nChatBkt.getRate(), nChatBkt.getPer(), nChatBkt.getAllowance());
+	// the client already aged them by the time they took to get here
+	actionLimiter = nActionBkt;
+	chatLimiter = nChatBkt;
 
 	if (sseq != nSseq) {
 		// client was teleported or is out of sync
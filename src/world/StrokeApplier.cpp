@@ -0,0 +1,105 @@
+#include "world/StrokeApplier.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "util/misc.hpp"
+#include "tools/ToolManager.hpp"
+#include "tools/providers/ColorProvider.hpp"
+#include "tools/impl/PencilTool.hpp"
+#include "world/CursorStore.hpp"
+
+// longer jumps than this are drawn as a new stroke instead of a line
+static constexpr WorldPos maxSegmentLen = 512;
+
+StrokeApplier::StrokeApplier(CursorStore& nCursors, ToolManager& nTm, ChunkWriter nWrite)
+: cursors(nCursors),
+  tm(nTm),
+  write(std::move(nWrite)),
+  scratchState(net::TID_UNKNOWN),
+  lastStats{},
+  batch(0) { }
+
+void StrokeApplier::apply(const std::vector<net::ToolAction<net::DAbsWPos>>& abs,
+		const std::vector<net::ToolAction<net::DRelWPos>>& rel, Cursor::Id self) {
+	++batch;
+	lastStats = {};
+	lastStats.actions = abs.size() + rel.size();
+
+	for (const auto& [pid, x, y, tid, tstate] : abs) {
+		if (pid.get() != self) {
+			handle(pid.get(), x, y, tid, tstate.get());
+		}
+	}
+
+	for (const auto& [pid, relX, relY, tid, tstate] : rel) {
+		auto s = cursors.find(pid.get());
+		if (pid.get() == self || s == CursorStore::npos) {
+			continue; // nothing to be relative to
+		}
+
+		handle(pid.get(), cursors.getX(s) + relX, cursors.getY(s) + relY, tid, tstate.get());
+	}
+
+	// players that didn't act this batch lifted the pencil
+	std::erase_if(lastPoints, [this] (const auto& e) {
+		return e.second.batch != batch;
+	});
+
+	flush();
+}
+
+const StrokeApplier::Stats& StrokeApplier::getLastStats() const {
+	return lastStats;
+}
+
+void StrokeApplier::handle(Cursor::Id pid, WorldPos x, WorldPos y, u8 tid, u64 tstate) {
+	// decode with the tool's own net codec, without touching the cursor's visible state
+	tm.updateState(scratchState, tid, tstate);
+	if (tid != net::TID_PENCIL || !scratchState.get<PencilTool>().isClicking()) {
+		lastPoints.erase(pid);
+		return;
+	}
+
+	RGB_u clr = scratchState.get<ColorProvider>().getPrimaryColor();
+	auto plot = [this, clr] (WorldPos px, WorldPos py) {
+		Chunk::Pos cx = px >> Chunk::posShift;
+		Chunk::Pos cy = py >> Chunk::posShift;
+		pixels.push_back({Chunk::key(cx, cy), cx, cy, {
+			static_cast<u16>(px & (Chunk::size - 1)), static_cast<u16>(py & (Chunk::size - 1)), clr
+		}});
+	};
+
+	auto it = lastPoints.find(pid);
+	if (it != lastPoints.end()
+			&& std::abs(x - it->second.x) <= maxSegmentLen && std::abs(y - it->second.y) <= maxSegmentLen) {
+		line(it->second.x, it->second.y, x, y, plot);
+		it->second = {x, y, batch};
+	} else {
+		plot(x, y);
+		lastPoints[pid] = {x, y, batch};
+	}
+}
+
+void StrokeApplier::flush() {
+	lastStats.pixels = pixels.size();
+
+	// stable, so overlapping strokes keep the order they were received in
+	std::stable_sort(pixels.begin(), pixels.end(), [] (const StrokePx& a, const StrokePx& b) {
+		return a.chunk < b.chunk;
+	});
+
+	for (sz_t i = 0; i < pixels.size();) {
+		const StrokePx& first = pixels[i];
+		run.clear();
+		for (; i < pixels.size() && pixels[i].chunk == first.chunk; i++) {
+			run.emplace_back(pixels[i].px);
+		}
+
+		if (write(first.cx, first.cy, run.data(), run.size())) {
+			++lastStats.chunks;
+		}
+	}
+
+	pixels.clear();
+}
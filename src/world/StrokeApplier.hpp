@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <unordered_map>
+
+#include "util/explints.hpp"
+#include "tools/ToolStates.hpp"
+#include "world/Chunk.hpp"
+#include "world/Cursor.hpp"
+#include "PacketDefinitions.hpp"
+
+class CursorStore;
+class ToolManager;
+
+// paints what other players draw. a batch of tool actions is rasterized first,
+// then sorted by chunk so every touched chunk gets one write and one renderer signal.
+class StrokeApplier {
+public:
+	// writes one chunk's pixels, returns false if the chunk isn't loaded
+	using ChunkWriter = std::function<bool(Chunk::Pos, Chunk::Pos, const ChunkGlState::PxUpdate *, sz_t)>;
+
+	struct Stats {
+		u32 actions;
+		u32 pixels;
+		u32 chunks;
+	};
+
+private:
+	struct StrokePx {
+		Chunk::Key chunk;
+		Chunk::Pos cx;
+		Chunk::Pos cy;
+		ChunkGlState::PxUpdate px;
+	};
+
+	struct LastPoint {
+		WorldPos x;
+		WorldPos y;
+		u32 batch; // strokes only continue into the next batch
+	};
+
+	CursorStore& cursors;
+	ToolManager& tm;
+	ChunkWriter write;
+	std::vector<StrokePx> pixels;
+	std::vector<ChunkGlState::PxUpdate> run;
+	std::unordered_map<Cursor::Id, LastPoint> lastPoints; // players with the pencil down
+	ToolStates scratchState; // for players whose cursor we don't have
+	Stats lastStats;
+	u32 batch;
+
+public:
+	StrokeApplier(CursorStore&, ToolManager&, ChunkWriter);
+
+	// absolute positions are world positions, relative ones are from the player's cursor.
+	// actions of self are skipped, they were drawn locally
+	void apply(const std::vector<net::ToolAction<net::DAbsWPos>>& abs,
+			const std::vector<net::ToolAction<net::DRelWPos>>& rel, Cursor::Id self);
+	const Stats& getLastStats() const;
+
+private:
+	void handle(Cursor::Id, WorldPos x, WorldPos y, u8 tid, u64 tstate);
+	void flush();
+};
@@ -0,0 +1,82 @@
+#include "world/VisibleChunks.hpp"
+
+bool VisibleChunks::Rect::contains(Chunk::Pos x, Chunk::Pos y) const {
+	return x >= tlx && x <= brx && y >= tly && y <= bry;
+}
+
+VisibleChunks::VisibleChunks(std::unordered_map<Chunk::Key, Chunk>& nChunks)
+: chunks(nChunks),
+  rect{0, 0, -1, -1},
+  rebuilds(0),
+  dirty(true) { }
+
+bool VisibleChunks::update(Rect r) {
+	if (!dirty && r == rect) {
+		return false;
+	}
+
+	rect = r;
+	rebuild();
+	return true;
+}
+
+void VisibleChunks::invalidate() {
+	dirty = true;
+}
+
+void VisibleChunks::chunkAdded(const Chunk& c) {
+	dirty |= rect.contains(c.getX(), c.getY());
+}
+
+void VisibleChunks::chunkRemoved(const Chunk& c) {
+	dirty |= rect.contains(c.getX(), c.getY());
+}
+
+void VisibleChunks::chunkChanged(const Chunk& c) {
+	// this gets called for every pixel update, so no lookups
+	if (!dirty && rect.contains(c.getX(), c.getY())) {
+		dirty = states[indexOf(c.getX(), c.getY())] != c.getGlState().getLoadState();
+	}
+}
+
+const std::vector<VisibleChunks::Tile>& VisibleChunks::get(LoadState ls) const {
+	return byState[static_cast<sz_t>(ls)];
+}
+
+const VisibleChunks::Rect& VisibleChunks::getRect() const {
+	return rect;
+}
+
+sz_t VisibleChunks::size() const {
+	return states.size();
+}
+
+u32 VisibleChunks::getRebuildCount() const {
+	return rebuilds;
+}
+
+void VisibleChunks::rebuild() {
+	for (auto& v : byState) {
+		v.clear();
+	}
+
+	states.clear();
+	for (Chunk::Pos y = rect.tly; y <= rect.bry; y++) {
+		for (Chunk::Pos x = rect.tlx; x <= rect.brx; x++) {
+			auto it = chunks.find(Chunk::key(x, y));
+			Chunk * c = it != chunks.end() ? &it->second : nullptr;
+			LoadState ls = c ? c->getGlState().getLoadState() : LoadState::UNLOADED;
+
+			states.emplace_back(ls);
+			byState[static_cast<sz_t>(ls)].push_back({x, y, c});
+		}
+	}
+
+	++rebuilds;
+	dirty = false;
+}
+
+sz_t VisibleChunks::indexOf(Chunk::Pos x, Chunk::Pos y) const {
+	sz_t w = rect.brx - rect.tlx + 1;
+	return static_cast<sz_t>(y - rect.tly) * w + static_cast<sz_t>(x - rect.tlx);
+}
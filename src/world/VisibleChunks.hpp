@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <unordered_map>
+
+#include "util/explints.hpp"
+#include "world/Chunk.hpp"
+
+// the chunk tiles on screen, grouped by load state. only rebuilt when the tile rect changes
+// or a chunk in it is created, destroyed or changes state, so the renderer, loader and
+// unloader don't each look up every tile every time. tiles are only valid until the next
+// chunk gets created or destroyed.
+class VisibleChunks {
+public:
+	using LoadState = ChunkGlState::LoadState;
+
+	// in chunk coords, inclusive
+	struct Rect {
+		Chunk::Pos tlx;
+		Chunk::Pos tly;
+		Chunk::Pos brx;
+		Chunk::Pos bry;
+
+		bool contains(Chunk::Pos x, Chunk::Pos y) const;
+		bool operator==(const Rect&) const = default;
+	};
+
+	struct Tile {
+		Chunk::Pos x;
+		Chunk::Pos y;
+		Chunk * c; // null if there was no chunk there yet
+	};
+
+	static constexpr sz_t numStates = static_cast<sz_t>(LoadState::ERROR) + 1;
+
+private:
+	std::unordered_map<Chunk::Key, Chunk>& chunks;
+	std::array<std::vector<Tile>, numStates> byState;
+	std::vector<LoadState> states; // of every tile when it was last rebuilt, row major
+	Rect rect;
+	u32 rebuilds;
+	bool dirty;
+
+public:
+	VisibleChunks(std::unordered_map<Chunk::Key, Chunk>&);
+
+	// cheap if nothing changed, returns true if it had to rebuild
+	bool update(Rect);
+	void invalidate();
+
+	void chunkAdded(const Chunk&);
+	void chunkRemoved(const Chunk&);
+	// call when the load state of a chunk may have changed
+	void chunkChanged(const Chunk&);
+
+	const std::vector<Tile>& get(LoadState) const;
+	const Rect& getRect() const;
+	sz_t size() const;
+	u32 getRebuildCount() const;
+
+private:
+	void rebuild();
+	sz_t indexOf(Chunk::Pos x, Chunk::Pos y) const;
+};
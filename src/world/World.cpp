@@ -7,6 +7,7 @@
 #include <optional>
 #include <cstdio>
 #include <cmath>
+#include <tuple>
 
 #include "InputManager.hpp"
 #include "Camera.hpp"
@@ -14,6 +15,7 @@
 #include "PacketDefinitions.hpp"
 
 #include "util/emsc/dom.hpp"
+#include "util/emsc/time.hpp"
 #include "util/byteswap.hpp"
 #include "util/explints.hpp"
 #include "util/misc.hpp"
@@ -25,19 +27,25 @@ World::World(Client& cl, InputAdapter& base, std::string name, std::unique_ptr<S
   name(std::move(name)),
   bgClr(bgClr),
   r(*this),
+  visible(chunks),
   currentAreaSyncSeq(0),
   expectedAreaSyncSeq(0),
   owner(std::move(owner)),
   me(_me->build(*this)),
   aWorld(base.mkAdapter("World")),
   toolMan(*this, me.getToolStates(), aWorld),
+  strokes(cursors, toolMan, [this] (Chunk::Pos x, Chunk::Pos y, const ChunkGlState::PxUpdate * px, sz_t n) {
+		Chunk * c = getChunk(x, y);
+		return c && c->setPixels(px, n, false);
+	}),
   toolWin(toolMan),
   posUi(me.getX(), me.getY(), r.getZoom()),
   settingsBtn("settings", "Settings"),
   helpBtn("help", "Help"),
   iMoveCursor(aWorld, "Move cursor", T_ONENTER | T_ONPRESS | T_ONMOVE | T_ONWHEEL | T_ONLEAVE | T_OPT_ALWAYS),
   tickNum(0),
-  drawingRestricted(restricted) {
+  drawingRestricted(restricted),
+  chunkLoadingPaused(false) {
 
 	toolMan.updateState(me.getToolStates(), _me->getTid(), _me->getTid());
 
@@ -112,15 +120,17 @@ sz_t World::unloadChunks(sz_t targetAmount) {
 		value_type& operator*() { return *this; }
 	};
 
+	VisibleChunks::Rect vis = r.getVisibleChunkRect();
+
 	do {
 		auto end = std::partial_sort_copy(
 				it_wrap{chunks.cbegin()}, it_wrap{chunks.cend()},
 				toUnload.begin(), toUnload.begin() + std::min(targetAmount, toUnload.size()),
-				[this] (const cit_t& a, const cit_t& b) {
+				[this, &vis] (const cit_t& a, const cit_t& b) {
 					bool unlA = a->second.shouldUnload();
 					bool unlB = b->second.shouldUnload();
-					bool visA = r.isChunkVisible(a->second);
-					bool visB = r.isChunkVisible(b->second);
+					bool visA = vis.contains(a->second.getX(), a->second.getY());
+					bool visB = vis.contains(b->second.getX(), b->second.getY());
 
 					// order of unloading: non-visible far to closest, visible far to closest
 					// non-unloadable chunks go last
@@ -203,6 +213,10 @@ bool World::freeMemory(bool tryHarder) {
 	return false;
 }
 
+void World::pauseChunkLoading(bool state) {
+	chunkLoadingPaused = state;
+}
+
 sz_t World::getMaxLoadedChunks() const {
 	sz_t mv = r.getMaxVisibleChunks();
 	return std::min(std::max(std::min(mv * 8, 128ul), mv), Renderer::maxLoadedChunks);
@@ -236,10 +250,28 @@ ToolManager& World::getToolManager() {
 	return toolMan;
 }
 
-const std::vector<Cursor>& World::getCursors() const {
+const CursorStore& World::getCursors() const {
 	return cursors;
 }
 
+bool World::interpolateCursors() {
+	return cursors.interpolate(getTime());
+}
+
+float World::getCursorPredictionHorizon() const {
+	return cursors.getPredictionHorizon();
+}
+
+void World::setCursorPredictionHorizon(float ms) {
+	cursors.setPredictionHorizon(ms);
+	r.queueRerender();
+}
+
+const VisibleChunks& World::getVisibleChunks() {
+	visible.update(r.getVisibleChunkRect());
+	return visible;
+}
+
 const std::unordered_map<Chunk::Key, Chunk>& World::getChunkMap() const {
 	return chunks;
 }
@@ -256,6 +288,7 @@ Chunk * World::getChunk(Chunk::Pos x, Chunk::Pos y) {
 Chunk& World::getOrMkChunk(Chunk::Pos x, Chunk::Pos y) {
 	auto it = chunks.try_emplace(Chunk::key(x, y), x, y, *this);
 	if (it.second) { // if a chunk was emplaced
+		visible.chunkAdded(it.first->second);
 		r.queueRerender();
 		unloadNonVisibleNonReadyChunks();
 
@@ -295,6 +328,7 @@ const char * World::getChunkUrl(Chunk::Pos x, Chunk::Pos y) {
 
 void World::signalChunkLoaded(Chunk * c) {
 	r.chunkToUpdate(c);
+	visible.chunkChanged(*c);
 
 	// a chunk just got loaded, instead of waiting another tick to start another request,
 	// check now to maintain the 4 concurrent chunk loads.
@@ -304,10 +338,16 @@ void World::signalChunkLoaded(Chunk * c) {
 
 void World::signalChunkUpdated(Chunk * c) {
 	r.chunkToUpdate(c);
+	visible.chunkChanged(*c);
 }
 
 void World::signalChunkUnloaded(Chunk * c) {
 	r.chunkUnloaded(c);
+	visible.chunkRemoved(*c);
+}
+
+void World::signalChunkStateChanged(Chunk * c) {
+	visible.chunkChanged(*c);
 }
 
 void World::loadMissingChunksTick(bool allowSubscribes) {
@@ -315,30 +355,42 @@ void World::loadMissingChunksTick(bool allowSubscribes) {
 	sorted.clear();
 	sorted.reserve(r.getMaxVisibleChunks());
 
-	if (!r.getGlContext().ok()) {
+	if (!r.getGlContext().ok() || chunkLoadingPaused) {
 		// skip loading chunks if the rendering context isn't valid
 		return;
 	}
 
+	// making chunks invalidates the tile lists, copy the missing positions first
+	missingChunks.clear();
+	for (const auto& t : getVisibleChunks().get(VisibleChunks::LoadState::UNLOADED)) {
+		missingChunks.emplace_back(mk_twoi32(t.x, t.y));
+	}
+
+	for (twoi32 pos : missingChunks) {
+		getOrMkChunk(pos.c.x, pos.c.y);
+	}
+
 	int numLoading = 0;
+	const VisibleChunks& vis = getVisibleChunks();
 
-	iterateScreenTiles(Chunk::size, [&, this] (twoi32 pos) {
-		Chunk& c = getOrMkChunk(pos.c.x, pos.c.y);
-		if (c.isReady()) {
-			return;
-		}
+	for (auto ls : {VisibleChunks::LoadState::UNLOADED, VisibleChunks::LoadState::LOADING, VisibleChunks::LoadState::ERROR}) {
+		for (const auto& t : vis.get(ls)) {
+			if (!t.c) {
+				continue; // got unloaded right away, over the limit
+			}
 
-		if (c.isLoading()) {
-			++numLoading;
-			return;
-		}
+			if (t.c->isLoading()) {
+				++numLoading;
+				continue;
+			}
 
-		auto it = std::lower_bound(sorted.begin(), sorted.end(), &c, [this] (const Chunk* c2, const Chunk* c1) {
-			return getDistanceToChunk(*c1) > getDistanceToChunk(*c2);
-		});
+			auto it = std::lower_bound(sorted.begin(), sorted.end(), t.c, [this] (const Chunk* c2, const Chunk* c1) {
+				return getDistanceToChunk(*c1) > getDistanceToChunk(*c2);
+			});
 
-		sorted.emplace(it, &c);
-	});
+			sorted.emplace(it, t.c);
+		}
+	}
 
 	bool needsSubscribe = false;
 	for (auto it = sorted.begin(); it != sorted.end() && numLoading < 4; ++it) {
@@ -442,62 +494,34 @@ sz_t World::unloadChunksPred(Func f) {
 }
 
 
-template<typename Func>
-void World::iterateScreenTiles(i32 tileSize, Func f) {
-	double w, h;
-	r.getScreenSize(&w, &h);
-
-	float hVpWidth = w / 2.f / r.getZoom();
-	float hVpHeight = h / 2.f / r.getZoom();
-	float tlx = std::floor((r.getX() - hVpWidth) / tileSize);
-	float tly = std::floor((r.getY() - hVpHeight) / tileSize);
-	float brx = std::floor((r.getX() + hVpWidth) / tileSize);
-	float bry = std::floor((r.getY() + hVpHeight) / tileSize);
-
-	for (; tly <= bry; tly += 1.f) {
-		for (float tlx2 = tlx; tlx2 <= brx; tlx2 += 1.f) {
-			twoi32 pos = mk_twoi32(tlx2, tly);
-			f(pos);
-		}
-	}
-}
-
 void World::handleUpdates(net::DAbsUpdAreaPos uaX, net::DAbsUpdAreaPos uaY, net::VPlayersHide hides, net::VPlayersShow shows, net::VPlayersUpdate updates) {
-	const auto lowerBoundById = [this] (Cursor::Id id) {
-		return std::lower_bound(cursors.begin(), cursors.end(), id, [] (const Cursor& c, Cursor::Id id) {
-			return id < c.getId();
-		});
-	};
-
-	const auto findById = [&, this] (Cursor::Id id) {
-		auto it = lowerBoundById(id);
-		if (it != cursors.end() && it->getId() != id) {
-			it = cursors.end();
-		}
-
-		return it;
-	};
+	// 0 until the clock is synced, then cursors are predicted from when the server sent this
+	cursors.setLatency(cl.getClockSync().getOneWayDelay());
 
 	bool needsRender = false;
 
 	for (auto pid : hides) {
-		auto it = findById(pid);
-		if (it != cursors.end()) {
-			auto curUArea = it->getUpdArea();
+		auto s = cursors.find(pid);
+		if (s != CursorStore::npos) {
+			auto curUArea = cursors.getUpdArea(s);
 			if (curUArea.c.x != uaX || curUArea.c.y != uaY) {
 				// see below explanation for details. in this case, delete is being received last.
 				continue;
 			}
 			needsRender |= true; // r.isPlayerVisible(*it)
 			//std::printf("del %llu\n", pid.get());
-			cursors.erase(it);
+			cursors.remove(s);
 		}
 	}
 
 	for (const auto& [pid, relX, relY, step, tid, tstate] : updates) {
-		auto it = findById(pid);
-		assert((it != cursors.end() && "updated a non existent cursor!"));
-		auto curUArea = it->getUpdArea();
+		auto s = cursors.find(pid);
+		assert((s != CursorStore::npos && "updated a non existent cursor!"));
+		if (s == CursorStore::npos) {
+			continue;
+		}
+
+		auto curUArea = cursors.getUpdArea(s);
 		if (curUArea.c.x != uaX || curUArea.c.y != uaY) {
 			// this can happen because order of received updates for each update region is not guaranteed, so
 			// if a cursor crosses an update area, a final relative update is sent on the original UA
@@ -509,31 +533,31 @@ void World::handleUpdates(net::DAbsUpdAreaPos uaX, net::DAbsUpdAreaPos uaY, net:
 		//if (!isSubscribedToUpdateArea(it->getUpdArea())) {
 		//	std::printf("[ERR] ");
 		//}
-		//std::printf("upd %llu, abspos_b %d, %d", pid.get(), it->getX(), it->getY());
-		needsRender |= it->updateRel(relX, relY, step, toolMan, tid, tstate);
-		auto uare = it->getUpdArea();
-		//std::printf(" abspos_a %d, %d, relpos, %lld, %lld, ua %d, %d", it->getX(), it->getY(), relX.get(), relY.get(), uare.c.x, uare.c.y);
+		//std::printf("upd %llu, abspos_b %d, %d", pid.get(), cursors.getX(s), cursors.getY(s));
+		needsRender |= cursors.updateRel(s, relX, relY, step, toolMan, tid, tstate);
+		auto uare = cursors.getUpdArea(s);
+		//std::printf(" abspos_a %d, %d, relpos, %lld, %lld, ua %d, %d", cursors.getX(s), cursors.getY(s), relX.get(), relY.get(), uare.c.x, uare.c.y);
 		if (!isSubscribedToUpdateArea(uare)) {
 			// if the player now lies outside of the subscribed update areas we won't receive any more updates from it
 			// so, forget the player
 			// TODO: despawn after moving animation finishes
 			//std::printf(" & del");
-			cursors.erase(it);
+			cursors.remove(s);
 		}
 		//std::printf("\n");
 	}
 
 	for (const auto& [uid, plUpd] : shows) {
 		const auto& [pid, absX, absY, step, tid, tstate] = plUpd;
-		auto it = lowerBoundById(pid);
-		if (it != cursors.end() && it->getId() == pid) {
+		auto s = cursors.find(pid);
+		if (s != CursorStore::npos) {
 			// can happen when crossing update regions.
 			// setting the absolute pos shouldn't be necessary but just in case there's error
 			//std::printf("newE %llu, pos %lld, %lld\n", pid.get(), absX.get(), absY.get());
-			needsRender |= it->update(absX, absY, step, toolMan, tid, tstate);
+			needsRender |= cursors.update(s, absX, absY, step, toolMan, tid, tstate);
 		} else {
 			//std::printf("new %llu, pos %lld, %lld\n", pid.get(), absX.get(), absY.get());
-			cursors.emplace(it, cl.getUser(uid), pid, absX, absY, step, toolMan, tid, tstate);
+			cursors.insert(cl.getUser(uid), pid, absX, absY, step, toolMan, tid, tstate);
 			needsRender |= true;
 		}
 	}
@@ -543,6 +567,11 @@ void World::handleUpdates(net::DAbsUpdAreaPos uaX, net::DAbsUpdAreaPos uaY, net:
 	}
 }
 
+void World::handleToolActions(const std::vector<net::ToolAction<net::DAbsWPos>>& abs,
+		const std::vector<net::ToolAction<net::DRelWPos>>& rel) {
+	strokes.apply(abs, rel, getCursor().getId());
+}
+
 void World::setSubscribedUpdateAreas(u8 arseq, std::vector<twoi32> areas) {
 	currentAreaSyncSeq = arseq;
 	if (arseq != expectedAreaSyncSeq) {
@@ -550,6 +579,20 @@ void World::setSubscribedUpdateAreas(u8 arseq, std::vector<twoi32> areas) {
 		return;
 	}
 
+	std::sort(areas.begin(), areas.end()); // for isSubscribedToUpdateArea
+
+	// we won't receive hides for cursors in the areas we left, forget them
+	sz_t droppedCursors = 0;
+	for (twoi32 a : subscribedUpdateAreas) {
+		if (!std::binary_search(areas.begin(), areas.end(), a)) {
+			droppedCursors += cursors.removeArea(a);
+		}
+	}
+
+	if (droppedCursors) {
+		r.queueRerender();
+	}
+
 	subscribedUpdateAreas = std::move(areas);
 	// we unload chunks that fall out of the subscribed areas because we are not going to
 	// receive pixel updates from there anymore.
@@ -566,33 +609,35 @@ void World::subscribeToUpdateAreas() {
 		return;
 	}
 
-	iterateScreenTiles(World::updateAreaSize, [this] (twoi32 pos) {
-		auto dist = getDistance2dSq(pos, getCursor().getUpdArea());
-		if (dist >= updateAreasMaxDist || subscribedUpdateAreas.size() >= updateAreasMaxNum) {
-			// skip if too far from cursor (extremely big screen?)
-			// or the max num of subscribed areas is reached (TODO: implement client-sided unsubscription)
-			return;
-		}
+	const auto& vis = getVisibleChunks().getRect();
+	twoi32 tl = updAreaOfChunk(vis.tlx, vis.tly);
+	twoi32 br = updAreaOfChunk(vis.brx, vis.bry);
+
+	for (i32 y = tl.c.y; y <= br.c.y; y++) {
+		for (i32 x = tl.c.x; x <= br.c.x; x++) {
+			twoi32 pos = mk_twoi32(x, y);
+			auto dist = getDistance2dSq(pos, getCursor().getUpdArea());
+			if (dist >= updateAreasMaxDist || subscribedUpdateAreas.size() >= updateAreasMaxNum) {
+				// skip if too far from cursor (extremely big screen?)
+				// or the max num of subscribed areas is reached (TODO: implement client-sided unsubscription)
+				continue;
+			}
 
-		auto it = std::lower_bound(subscribedUpdateAreas.begin(), subscribedUpdateAreas.end(), pos);
-		if (it == subscribedUpdateAreas.end() || *it != pos) {
-			//subscribedUpdateAreas.emplace(it, pos);
-			++expectedAreaSyncSeq;
-			std::printf("subscribing to %d, %d\n", pos.c.x, pos.c.y);
-			cl.send(SSubscribeArea::toBuffer(pos.c.x, pos.c.y, true));
+			auto it = std::lower_bound(subscribedUpdateAreas.begin(), subscribedUpdateAreas.end(), pos);
+			if (it == subscribedUpdateAreas.end() || *it != pos) {
+				//subscribedUpdateAreas.emplace(it, pos);
+				++expectedAreaSyncSeq;
+				std::printf("subscribing to %d, %d\n", pos.c.x, pos.c.y);
+				cl.send(SSubscribeArea::toBuffer(pos.c.x, pos.c.y, true));
+			}
 		}
-	});
+	}
 }
 
 bool World::isSubscribedToUpdateArea(twoi32 pos) {
 	return std::binary_search(subscribedUpdateAreas.begin(), subscribedUpdateAreas.end(), pos);
 }
 
-twoi32 World::updAreaOf(World::Pos x, World::Pos y) {
-	float uAreaSzf = updateAreaSize;
-	return mk_twoi32(std::floor(x / uAreaSzf), std::floor(y / uAreaSzf));
-}
-
 twoi32 World::updAreaOfChunk(Chunk::Pos x, Chunk::Pos y) {
 	std::int32_t uAreaSz = updateAreaSize / Chunk::size;
 	float uAreaSzf = uAreaSz;
@@ -16,7 +16,11 @@
 #include "uvias/User.hpp"
 #include "world/Chunk.hpp"
 #include "world/Cursor.hpp"
+#include "world/CursorStore.hpp"
 #include "world/SelfCursor.hpp"
+#include "world/StrokeApplier.hpp"
+#include "world/VisibleChunks.hpp"
+#include "world/WorldConstants.hpp"
 #include "tools/ToolManager.hpp"
 #include "InputManager.hpp"
 #include "Renderer.hpp"
@@ -32,31 +36,25 @@
 
 class Client;
 
-class World : NonCopyable {
+class World : public WorldConstants, NonCopyable {
 public:
-	// this is absolute pixel pos
-	using Pos = i32;
-
 	static constexpr Chunk::Pos border = 0xFFFFFF / Chunk::size; // 16777215
 	static constexpr sz_t maxNameLength = 24;
 
-	// in pixels, how big the update regions are
-	static constexpr i32 updateAreaSize = 2048;
 	static constexpr u32 updateAreasMaxNum = 20;
 	static constexpr u32 updateAreasMaxDist = 4;
 
-	// expected world update frequency in ms
-	static constexpr float updateRateMs = 50.f;
-
 private:
 	Client& cl;
 	const std::string name;
 	RGB_u bgClr;
 	Renderer r;
 
+	VisibleChunks visible; // before chunks, their destructors signal it
 	std::unordered_map<Chunk::Key, Chunk> chunks;
-	std::vector<Cursor> cursors; // visible cursors only, sorted by pid
+	CursorStore cursors; // visible cursors only
 	std::vector<twoi32> subscribedUpdateAreas;
+	std::vector<twoi32> missingChunks; // loadMissingChunksTick() scratch
 	u8 currentAreaSyncSeq;
 	u8 expectedAreaSyncSeq;
 
@@ -68,6 +66,7 @@ private:
 
 	InputAdapter& aWorld;
 	ToolManager toolMan;
+	StrokeApplier strokes;
 	ToolWindow toolWin;
 	PositionWidget posUi;
 	PlayerCountWidget pCntUi;
@@ -80,6 +79,7 @@ private:
 
 	u16 tickNum;
 	bool drawingRestricted;
+	bool chunkLoadingPaused;
 
 	decltype(ToolManager::onLocalStateChanged)::SlotKey toolChSk;
 
@@ -98,6 +98,8 @@ public:
 	bool freeMemory(bool tryHarder = false);
 
 	sz_t getMaxLoadedChunks() const;
+	// stops making and requesting chunks, for the render bench
+	void pauseChunkLoading(bool);
 
 	Box<eui::Object, eui::Object>& getLlCornerUi();
 
@@ -111,8 +113,12 @@ public:
 	void recalculateCursorPosition();
 	void recalculateCursorPosition(const InputInfo&);
 
-	const std::vector<Cursor>& getCursors() const;
+	const CursorStore& getCursors() const;
+	bool interpolateCursors(); // once per frame, true while any cursor is moving
+	float getCursorPredictionHorizon() const;
+	void setCursorPredictionHorizon(float ms);
 	const std::unordered_map<Chunk::Key, Chunk>& getChunkMap() const;
+	const VisibleChunks& getVisibleChunks();
 	Chunk * getChunk(Chunk::Pos, Chunk::Pos);
 	Chunk& getOrMkChunk(Chunk::Pos, Chunk::Pos);
 	Chunk * getChunkAtPx(World::Pos, World::Pos);
@@ -127,23 +133,21 @@ public:
 	void signalChunkLoaded(Chunk *);
 	void signalChunkUpdated(Chunk *);
 	void signalChunkUnloaded(Chunk *);
+	void signalChunkStateChanged(Chunk *);
 
 	void updateUi();
 
 	void handleUpdates(net::DAbsUpdAreaPos x, net::DAbsUpdAreaPos y, net::VPlayersHide, net::VPlayersShow, net::VPlayersUpdate);
+	void handleToolActions(const std::vector<net::ToolAction<net::DAbsWPos>>&, const std::vector<net::ToolAction<net::DRelWPos>>&);
 	void setSubscribedUpdateAreas(u8 arseq, std::vector<twoi32> areas);
 	bool isSubscribedToUpdateArea(twoi32 pos);
 
-	static twoi32 updAreaOf(World::Pos x, World::Pos y);
 	static twoi32 updAreaOfChunk(Chunk::Pos x, Chunk::Pos y);
 
 private:
 	template<typename Func>
 	sz_t unloadChunksPred(Func f);
 
-	template<typename Func>
-	void iterateScreenTiles(i32 tileSize, Func f);
-
 	float getDistanceToChunk(const Chunk&) const;
 	void loadMissingChunksTick(bool allowSubscribes = true);
 	void subscribeToUpdateAreas();
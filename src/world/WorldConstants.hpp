@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cmath>
+
+#include "util/explints.hpp"
+#include "util/misc.hpp"
+
+// the parts of World that cursors need, without pulling in the renderer and ui
+struct WorldConstants {
+	// this is absolute pixel pos
+	using Pos = i32;
+
+	// in pixels, how big the update regions are
+	static constexpr i32 updateAreaSize = 2048;
+
+	// expected world update frequency in ms
+	static constexpr float updateRateMs = 50.f;
+
+	static twoi32 updAreaOf(Pos x, Pos y) {
+		float uAreaSzf = updateAreaSize;
+		return mk_twoi32(std::floor(x / uAreaSzf), std::floor(y / uAreaSzf));
+	}
+};
@@ -0,0 +1,43 @@
+// rate limit buckets set from the server: the allowance it sent was measured before it got here
+
+#include "check.hpp"
+#include "fake_clock.hpp"
+#include "util/Bucket.hpp"
+
+int main() {
+	fakeNow = 100.0;
+
+	// 10 per 2s, 0 left when the server measured it, half a second ago: 2.5 refilled since
+	Bucket b(10, 2, 0.f, 0.5f);
+	CHECK(b.canSpend(2));
+	CHECK(!b.canSpend(3));
+	CHECK(b.spend(2));
+	CHECK(!b.spend(1));
+
+	// without the age, nothing yet
+	Bucket fresh(10, 2, 0.f);
+	CHECK(!fresh.canSpend(1));
+	fakeNow += 0.2;
+	CHECK(fresh.canSpend(1));
+	CHECK(!fresh.canSpend(2));
+
+	// set() starts counting from now, not from the last spend long ago
+	fakeNow += 60.0;
+	b.set(10, 2, 0.f);
+	CHECK(!b.canSpend(1));
+	fakeNow += 0.2;
+	CHECK(b.spend(1));
+	CHECK(!b.spend(1));
+
+	// never more than the rate
+	b.set(10, 2, 0.f, 60.f);
+	CHECK(b.canSpend(10));
+	CHECK(!b.canSpend(11));
+
+	// a period of 0 from the server is clamped like in set(), not a full bucket right away
+	Bucket zero(10, 0, 0.f, 0.5f);
+	CHECK(zero.canSpend(5));
+	CHECK(!zero.canSpend(6));
+
+	return checkResult();
+}
@@ -0,0 +1,129 @@
+// byte order of buf::write/read{BE,LE}, the bulk array versions, and arrays cut short
+// inside packets. floats are compared by their bits, so nan payloads and -0 count too
+
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <array>
+
+#include "check.hpp"
+#include "util/BufferHelper.hpp"
+#include "util/net/Packet.hpp"
+
+template<typename T>
+static u64 bitsOf(T v) {
+	u64 bits = 0;
+	std::memcpy(&bits, &v, sizeof(T)); // little endian host, the low bytes
+	return bits;
+}
+
+template<typename T>
+static bool sameBits(T a, T b) {
+	return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+template<typename T>
+static std::vector<T> samples() {
+	using L = std::numeric_limits<T>;
+	std::vector<T> v{T(0), T(1), L::min(), L::max(), L::lowest()};
+	if constexpr (std::is_floating_point_v<T>) {
+		v.insert(v.end(), {T(-0.0), T(0.1), T(-123.456), L::denorm_min(), L::infinity(), -L::infinity(), L::quiet_NaN()});
+	} else if constexpr (std::is_signed_v<T>) {
+		v.insert(v.end(), {T(-1), T(0x5A)});
+	} else if constexpr (sizeof(T) > 1) {
+		v.emplace_back(static_cast<T>(0x0102030405060708ull)); // a different byte everywhere
+	}
+
+	return v;
+}
+
+template<typename T>
+static void checkType() {
+	auto vals = samples<T>();
+	u8 b[sizeof(T)];
+
+	for (T v : vals) {
+		u64 bits = bitsOf(v);
+
+		CHECK(buf::writeBE(b, v) == sizeof(T));
+		for (sz_t i = 0; i < sizeof(T); i++) {
+			CHECK(b[i] == static_cast<u8>(bits >> (8 * (sizeof(T) - 1 - i))));
+		}
+
+		CHECK(sameBits(buf::readBE<T>(b), v));
+
+		CHECK(buf::writeLE(b, v) == sizeof(T));
+		for (sz_t i = 0; i < sizeof(T); i++) {
+			CHECK(b[i] == static_cast<u8>(bits >> (8 * i)));
+		}
+
+		CHECK(sameBits(buf::readLE<T>(b), v));
+	}
+
+	// bulk, at an odd offset so nothing is aligned, must match one writeBE per element
+	std::vector<u8> bulk(1 + vals.size() * sizeof(T));
+	std::vector<u8> single(bulk.size());
+	buf::writeBEArray(bulk.data() + 1, vals.data(), vals.size());
+	for (sz_t i = 0; i < vals.size(); i++) {
+		buf::writeBE(single.data() + 1 + i * sizeof(T), vals[i]);
+	}
+
+	CHECK(bulk == single);
+
+	std::vector<T> back(vals.size());
+	buf::readBEArray(back.data(), bulk.data() + 1, back.size());
+	for (sz_t i = 0; i < vals.size(); i++) {
+		CHECK(sameBits(back[i], vals[i]));
+	}
+
+	// whole packets: a vector and a fixed array, then every shorter prefix of them
+	using VecPkt = Packet<0, std::vector<T>>;
+	using ArrPkt = Packet<0, std::array<T, 4>, u8>;
+
+	std::vector<u8> msg;
+	VecPkt::toBuffer(msg, vals);
+	auto dec = VecPkt::tryFromBuffer(msg.data() + 1, msg.size() - 1);
+	CHECK(dec && std::get<0>(*dec).size() == vals.size());
+	for (sz_t i = 0; dec && i < vals.size(); i++) {
+		CHECK(sameBits(std::get<0>(*dec)[i], vals[i]));
+	}
+
+	for (sz_t n = 0; n + 1 < msg.size(); n++) {
+		CHECK(!VecPkt::tryFromBuffer(msg.data() + 1, n));
+	}
+
+	std::array<T, 4> arr{vals[0], vals[1], vals[2], vals[3]};
+	ArrPkt::toBuffer(msg, arr, 7);
+	CHECK(msg.size() == 1 + 4 * sizeof(T) + 1);
+	auto decArr = ArrPkt::tryFromBuffer(msg.data() + 1, msg.size() - 1);
+	CHECK(decArr && sameBits(std::get<0>(*decArr)[3], arr[3]) && std::get<1>(*decArr) == 7);
+	for (sz_t n = 0; n + 1 < msg.size(); n++) {
+		CHECK(!ArrPkt::tryFromBuffer(msg.data() + 1, n));
+	}
+}
+
+int main() {
+	checkType<char>();
+	checkType<i8>();
+	checkType<u8>();
+	checkType<i16>();
+	checkType<u16>();
+	checkType<i32>();
+	checkType<u32>();
+	checkType<i64>();
+	checkType<u64>();
+	checkType<float>();
+	checkType<double>();
+
+	// anything but 0 decodes as true, a bool holding another byte is ub
+	u8 raw[] = {0, 1, 2, 0xFF};
+	bool bs[4];
+	buf::readBEArray(bs, raw, 4);
+	CHECK(!bs[0] && bs[1] && bs[2] && bs[3]);
+
+	// a length prefix promising more than is there
+	u8 lying[] = {0x80 | 3, 0x01, 0xAA, 0xBB}; // 131 u16s, 2 bytes follow
+	CHECK(!(Packet<0, std::vector<u16>>::tryFromBuffer(lying, sizeof(lying))));
+
+	return checkResult();
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdio>
+
+// keeps going after a failure, so one run lists all of them. main returns checkResult()
+inline int checkFailures = 0;
+
+#define CHECK(cond) do { \
+		if (!(cond)) { \
+			std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			++checkFailures; \
+		} \
+	} while (false)
+
+inline int checkResult() {
+	if (checkFailures) {
+		std::printf("%d checks failed\n", checkFailures);
+	}
+
+	return checkFailures != 0;
+}
@@ -0,0 +1,82 @@
+// ClockSync against a stand-in server: a fixed delay each way plus exponential queueing,
+// a clock far from ours, and pongs that get lost
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "check.hpp"
+#include "util/net/ClockSync.hpp"
+
+struct StandIn {
+	double oneWay; // ms, each way
+	double queueing; // ms, mean of the extra delay, each way
+	double offset; // server clock - ours
+	u32 dropEvery; // 0 to never drop a pong
+};
+
+// returns the error of the estimated offset after pings pings, one every 2s
+static double run(ClockSync& cs, const StandIn& si, u32 pings, u32 seed) {
+	std::mt19937 rng(seed);
+	std::exponential_distribution<double> queue(1.0 / si.queueing);
+	double now = 1000.0;
+	for (u32 i = 0; i < pings; i++, now += 2000.0) {
+		u16 seq = cs.sent(now);
+		double atServer = now + si.oneWay + queue(rng);
+		double back = atServer + si.oneWay + queue(rng);
+		if (si.dropEvery && i % si.dropEvery == si.dropEvery - 1) {
+			continue;
+		}
+
+		CHECK(cs.received(seq, atServer + si.offset, back));
+	}
+
+	return std::abs(cs.getStats().offset - si.offset);
+}
+
+int main() {
+	const StandIn si{40.0, 15.0, 12300.0, 0};
+
+	ClockSync cs;
+	CHECK(!cs.isSynced());
+	CHECK(cs.getOneWayDelay() == 0.0);
+
+	double err = run(cs, si, 60, 1);
+	const auto& st = cs.getStats();
+	std::printf("40ms each way, 15ms queueing, 60 pings: offset error %.2fms, srtt %.1fms, jitter %.1fms\n",
+			err, st.srtt, st.jitter);
+
+	CHECK(cs.isSynced());
+	// the best sample's queueing could all be on one leg, which is as wrong as it can get
+	CHECK(err <= (st.minRtt - 2.0 * si.oneWay) / 2.0 + 1e-9);
+	CHECK(err < 5.0);
+	CHECK(st.samples == 60 && st.lost == 0);
+	CHECK(st.minRtt >= 80.0 && st.minRtt <= st.srtt);
+	CHECK(std::abs(cs.getOneWayDelay() - st.srtt / 2.0) < 1e-9);
+	CHECK(std::abs(cs.toLocalTime(cs.toServerTime(5000.0)) - 5000.0) < 1e-9);
+
+	// one pong in 7 lost: the ping slot is reused later and counted as lost
+	cs.reset();
+	err = run(cs, {40.0, 15.0, -7000.0, 7}, 70, 2);
+	std::printf("same, 1 in 7 pongs lost: offset error %.2fms, %u lost\n", err, cs.getStats().lost);
+	CHECK(err < 5.0);
+	CHECK(cs.getStats().lost > 0);
+
+	// not trusted before minSamples
+	cs.reset();
+	CHECK(cs.getStats().samples == 0);
+	run(cs, si, ClockSync::minSamples - 1, 3);
+	CHECK(!cs.isSynced() && cs.getOneWayDelay() == 0.0);
+	run(cs, si, 1, 4);
+	CHECK(cs.isSynced() && cs.getOneWayDelay() > 0.0);
+
+	// pongs for pings we didn't send, or already got, are ignored
+	cs.reset();
+	u16 seq = cs.sent(0.0);
+	CHECK(!cs.received(seq + 1, 100.0, 50.0));
+	CHECK(cs.received(seq, 100.0, 50.0));
+	CHECK(!cs.received(seq, 100.0, 60.0));
+	CHECK(cs.getStats().samples == 1);
+
+	return checkResult();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+// what the cursor code links against in the client, for native tests and benches, on top of
+// the fake clock. include it from one file per binary, it defines functions
+
+#include <cstddef>
+
+#include "tools/ToolManager.hpp"
+#include "tools/ToolStates.hpp"
+#include "util/color.hpp"
+#include "PacketDefinitions.hpp"
+#include "fake_clock.hpp"
+
+class User;
+
+ColorProvider::State::State()
+: primaryColor{{0, 0, 0, 255}},
+  secondaryColor{{255, 255, 255, 255}} { }
+
+PencilTool::State::State()
+: clicking(false),
+  brushSize(1),
+  brushShape(0),
+  ditherType(0) { }
+
+MoveTool::State::State()
+: clicking(false) { }
+
+ZoomTool::State::State()
+: zoom(0) { }
+
+PipetteTool::State::State()
+: clicking(false) { }
+
+bool PencilTool::State::isClicking() const {
+	return clicking;
+}
+
+bool PencilTool::State::setClicking(bool s) {
+	bool changed = clicking != s;
+	clicking = s;
+	return changed;
+}
+
+RGB_u ColorProvider::State::getPrimaryColor() const {
+	return primaryColor;
+}
+
+bool ColorProvider::State::setPrimaryColor(RGB_u clr) {
+	bool changed = clr.rgb != primaryColor.rgb;
+	primaryColor = clr;
+	return changed;
+}
+
+// not the real codecs, see fakePencilState
+bool ToolManager::updateState(ToolStates& ts, std::uint8_t newTid, std::uint64_t newState) {
+	bool changed = ts.getSelectedToolNetId() != newTid;
+	ts.setSelectedToolNetId(newTid);
+	if (newTid == net::TID_PENCIL) {
+		changed |= ts.get<PencilTool>().setClicking(newState >> 32 & 1);
+		changed |= ts.get<ColorProvider>().setPrimaryColor({.rgb = static_cast<u32>(newState)});
+	}
+
+	return changed;
+}
+
+// what updateState above decodes for the pencil
+inline u64 fakePencilState(bool clicking, RGB_u clr) {
+	return static_cast<u64>(clicking) << 32 | clr.rgb;
+}
+
+// the real one needs a World. updateState above doesn't touch it
+inline ToolManager& fakeToolManager() {
+	alignas(ToolManager) static unsigned char storage[sizeof(ToolManager)];
+	return *reinterpret_cast<ToolManager *>(storage);
+}
+
+// cursors only keep a pointer to their user
+inline User& fakeUser() {
+	alignas(std::max_align_t) static unsigned char storage[1];
+	return *reinterpret_cast<User *>(storage);
+}
@@ -0,0 +1,155 @@
+// remote cursor dead reckoning: a simulated player moving at a steady speed, seen through
+// 50ms updates with latency and jitter. prediction should keep the drawn cursor closer to
+// where the player really is, and settle exactly on the last position once they stop.
+// like the server, nothing is sent while the player stands still
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "check.hpp"
+#include "cursor_env.hpp"
+#include "world/CursorStore.hpp"
+#include "world/WorldConstants.hpp"
+
+struct Lag {
+	double mean;
+	double max;
+	double overshoot; // px past where the player stopped
+	double settle; // s from the stop until the cursor stays on the last position
+};
+
+// px/s along x, for `moving` seconds, then still
+static Lag simulate(float horizonMs, float latencyMs, float speed, double moving, CursorStore& cs) {
+	constexpr double latency = 0.030;
+	constexpr double jitter = 0.008;
+	constexpr double frame = 1.0 / 60.0;
+	const double interval = WorldConstants::updateRateMs / 1000.0;
+	std::mt19937 rng(99);
+	std::uniform_real_distribution<double> jit(-jitter, jitter);
+
+	auto truePos = [&] (double t) {
+		return static_cast<float>(speed * std::min(t, moving));
+	};
+
+	// the server sends the position every interval, we get them in order, late
+	struct Upd {
+		double arrives;
+		WorldPos x;
+	};
+
+	std::vector<Upd> upds;
+	double lastArrival = 0.0;
+	WorldPos lastSent = 0;
+	for (double t = interval; t < moving + 1.0; t += interval) {
+		auto x = static_cast<WorldPos>(std::floor(truePos(t)));
+		if (x == lastSent) {
+			continue;
+		}
+
+		lastArrival = std::max(lastArrival, t + latency + jit(rng));
+		upds.push_back({lastArrival, x});
+		lastSent = x;
+	}
+
+	cs.clear();
+	cs.setPredictionHorizon(horizonMs);
+	cs.setLatency(latencyMs);
+	fakeNow = 0.0;
+	CursorStore::Slot s = cs.insert(fakeUser(), 1, 0, 0, 0, fakeToolManager(), 0, 0);
+
+	Lag lag{0.0, 0.0, 0.0, 0.0};
+	u32 frames = 0;
+	sz_t next = 0;
+	for (fakeNow = frame; fakeNow < moving; fakeNow += frame) {
+		for (; next < upds.size() && upds[next].arrives <= fakeNow; next++) {
+			cs.update(s, upds[next].x, 0, 0, fakeToolManager(), 0, 0);
+		}
+
+		cs.interpolate(fakeNow);
+		// skip the first half second, the velocity estimate needs a few updates
+		if (fakeNow > 0.5) {
+			double d = std::abs(truePos(fakeNow) - cs.getDrawX(s));
+			lag.mean += d;
+			lag.max = std::max(lag.max, d);
+			++frames;
+		}
+	}
+
+	// stopped: the rest of the updates arrive, then it must come to rest where they said
+	const double stop = fakeNow;
+	for (; fakeNow < moving + 1.5; fakeNow += frame) {
+		for (; next < upds.size() && upds[next].arrives <= fakeNow; next++) {
+			cs.update(s, upds[next].x, 0, 0, fakeToolManager(), 0, 0);
+		}
+
+		cs.interpolate(fakeNow);
+		double off = cs.getDrawX(s) - upds.back().x;
+		lag.overshoot = std::max(lag.overshoot, off);
+		if (std::abs(off) > 0.5) {
+			lag.settle = fakeNow - stop;
+		}
+	}
+
+	CHECK(!cs.interpolate(fakeNow));
+	CHECK(cs.getDrawX(s) == cs.getFinalX(s));
+	CHECK(cs.getX(s) == upds.back().x);
+
+	lag.mean /= frames;
+	return lag;
+}
+
+int main() {
+	CursorStore cs;
+	const float def = cs.getPredictionHorizon();
+	CHECK(def == WorldConstants::updateRateMs);
+
+	Lag plain = simulate(0.f, 0.f, 300.f, 3.0, cs);
+	Lag predicted = simulate(def, 0.f, 300.f, 3.0, cs);
+	std::printf("300px/s, 30ms +-8ms latency: mean lag %.1fpx -> %.1fpx, max %.1fpx -> %.1fpx\n",
+			plain.mean, predicted.mean, plain.max, predicted.max);
+
+	CHECK(predicted.mean < plain.mean * 0.7);
+	CHECK(predicted.max < plain.max);
+
+	// knowing the latency, it predicts from when the update was sent instead of when it arrived
+	Lag sent = simulate(def, 30.f, 300.f, 3.0, cs);
+	std::printf("same, predicting 30ms of latency: mean lag %.1fpx, max %.1fpx\n", sent.mean, sent.max);
+	CHECK(sent.mean < predicted.mean);
+
+	// the last update arrives up to latency + jitter after the stop, then the lead lasts the
+	// horizon and fades over one more interval. it never goes further than the lead
+	std::printf("after stopping: overshoot %.1fpx -> %.1fpx, settled in %.0fms -> %.0fms\n",
+			predicted.overshoot, sent.overshoot, predicted.settle * 1000.0, sent.settle * 1000.0);
+	struct Stop {
+		Lag l;
+		double hz;
+		double latencyMs;
+	};
+
+	for (const Stop& st : {Stop{plain, 0.0, 0.0}, Stop{predicted, def, 0.0}, Stop{sent, def, 30.0}}) {
+		CHECK(st.l.settle < 0.038 + (2.0 * WorldConstants::updateRateMs + st.hz) / 1000.0 + 1.0 / 60.0);
+		CHECK(st.l.overshoot <= 300.0 * (st.hz + st.latencyMs) / 1000.0 + 1.0);
+	}
+
+	// and does nothing without prediction
+	Lag plainSent = simulate(0.f, 30.f, 300.f, 3.0, cs);
+	CHECK(plainSent.mean == plain.mean);
+
+	// too fast to be a drag (over maxSampleJump per update): no velocity, no worse than plain
+	Lag fastPlain = simulate(0.f, 0.f, 8000.f, 2.0, cs);
+	Lag fastPredicted = simulate(def, 0.f, 8000.f, 2.0, cs);
+	CHECK(std::abs(fastPredicted.mean - fastPlain.mean) < 1.0);
+
+	// the horizon setter clamps and converts
+	cs.setPredictionHorizon(-5.f);
+	CHECK(cs.getPredictionHorizon() == 0.f);
+	cs.setPredictionHorizon(120.f);
+	CHECK(std::abs(cs.getPredictionHorizon() - 120.f) < 0.001f);
+	cs.setLatency(-1.f);
+	CHECK(cs.getLatency() == 0.f);
+
+	return checkResult();
+}
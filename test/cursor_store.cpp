@@ -0,0 +1,144 @@
+// CursorStore against a plain map of the same cursors, through random shows, moves and hides
+
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "check.hpp"
+#include "cursor_env.hpp"
+#include "world/CursorStore.hpp"
+#include "world/WorldConstants.hpp"
+
+struct Ref {
+	WorldPos x;
+	WorldPos y;
+	u8 tid;
+};
+
+static void checkSame(const CursorStore& cs, const std::map<CursorStore::Id, Ref>& ref) {
+	CHECK(cs.size() == ref.size());
+	for (const auto& [id, r] : ref) {
+		CursorStore::Slot s = cs.find(id);
+		CHECK(s != CursorStore::npos);
+		if (s == CursorStore::npos) {
+			continue;
+		}
+
+		CHECK(cs.getId(s) == id);
+		CHECK(cs.getX(s) == r.x && cs.getY(s) == r.y);
+		CHECK(cs.getToolStates(s).getSelectedToolNetId() == r.tid);
+	}
+
+	for (CursorStore::Slot s = 0; s < cs.size(); s++) {
+		CHECK(ref.count(cs.getId(s)) == 1);
+	}
+
+	std::set<twoi32> areas;
+	for (const auto& [id, r] : ref) {
+		areas.insert(WorldConstants::updAreaOf(r.x, r.y));
+	}
+
+	// areas left empty must not stay in the index
+	CHECK(cs.getAreaCount() == areas.size());
+}
+
+static void checkQuery(CursorStore& cs, float tlx, float tly, float brx, float bry) {
+	std::vector<CursorStore::Slot> got;
+	sz_t n = cs.queryRect(tlx, tly, brx, bry, got);
+	CHECK(n == got.size());
+
+	std::vector<CursorStore::Slot> want;
+	for (CursorStore::Slot s = 0; s < cs.size(); s++) {
+		float x = cs.getDrawX(s);
+		float y = cs.getDrawY(s);
+		if (x >= tlx && x <= brx && y >= tly && y <= bry) {
+			want.emplace_back(s);
+		}
+	}
+
+	std::sort(got.begin(), got.end());
+	CHECK(got == want);
+}
+
+int main() {
+	std::mt19937 rng(1234);
+	const i32 span = WorldConstants::updateAreaSize * 6;
+	auto pos = [&] { return static_cast<WorldPos>(rng() % span) - span / 2; };
+
+	CursorStore cs;
+	std::map<CursorStore::Id, Ref> ref;
+	ToolManager& tm = fakeToolManager();
+
+	for (u32 round = 0; round < 200; round++) {
+		fakeNow += 0.05;
+		for (u32 i = 0; i < 50; i++) {
+			CursorStore::Id id = rng() % 400;
+			auto it = ref.find(id);
+			CursorStore::Slot s = cs.find(id);
+			CHECK((it == ref.end()) == (s == CursorStore::npos));
+			switch (rng() % 3) {
+			case 0:
+				if (it == ref.end()) {
+					Ref r{pos(), pos(), static_cast<u8>(rng() % 4)};
+					cs.insert(fakeUser(), id, r.x, r.y, 0, tm, r.tid, 0);
+					ref.emplace(id, r);
+				}
+				break;
+
+			case 1:
+				if (it != ref.end()) {
+					// mostly short moves, some cross into other areas
+					WorldPos dx = static_cast<WorldPos>(rng() % 2001) - 1000;
+					WorldPos dy = static_cast<WorldPos>(rng() % 2001) - 1000;
+					u8 tid = rng() % 4;
+					cs.updateRel(s, dx, dy, 0, tm, tid, 0);
+					it->second = {it->second.x + dx, it->second.y + dy, tid};
+				}
+				break;
+
+			case 2:
+				if (it != ref.end()) {
+					cs.remove(s);
+					ref.erase(it);
+				}
+				break;
+			}
+		}
+
+		checkSame(cs, ref);
+		fakeNow += 0.02; // mid animation
+		cs.interpolate(fakeNow);
+		for (CursorStore::Slot s = 0; s < cs.size(); s++) {
+			// the batch pass and the per slot getters agree
+			CHECK(std::abs(cs.getDrawX(s) - cs.getSmoothX(s)) < 0.01f);
+			CHECK(std::abs(cs.getDrawY(s) - cs.getSmoothY(s)) < 0.01f);
+		}
+
+		checkQuery(cs, -1000.f, -1500.f, 3000.f, 800.f); // probes areas
+		checkQuery(cs, -span * 10.f, -span * 10.f, span * 10.f, span * 10.f); // scans the map
+	}
+
+	// dropping an area takes exactly the cursors that were in it
+	twoi32 area = WorldConstants::updAreaOf(0, 0);
+	sz_t inArea = std::count_if(ref.begin(), ref.end(), [&] (const auto& e) {
+		return WorldConstants::updAreaOf(e.second.x, e.second.y) == area;
+	});
+
+	CHECK(inArea > 0);
+	CHECK(cs.removeArea(area) == inArea);
+	std::erase_if(ref, [&] (const auto& e) {
+		return WorldConstants::updAreaOf(e.second.x, e.second.y) == area;
+	});
+
+	checkSame(cs, ref);
+	CHECK(cs.removeArea(area) == 0);
+
+	cs.clear();
+	CHECK(cs.empty() && cs.getAreaCount() == 0);
+
+	return checkResult();
+}
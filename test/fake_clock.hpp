@@ -0,0 +1,19 @@
+#pragma once
+
+// the client's frame clock, settable. include it from one file per binary, it defines functions
+
+#include <chrono>
+
+#include "util/emsc/time.hpp"
+
+// seconds, what getTime() and getStClock() return
+inline double fakeNow = 0.0;
+
+double getTime(bool) {
+	return fakeNow;
+}
+
+std::chrono::steady_clock::time_point getStClock(bool) {
+	using namespace std::chrono;
+	return steady_clock::time_point(duration_cast<steady_clock::duration>(duration<double>(fakeNow)));
+}
@@ -0,0 +1,99 @@
+// fixed layout tuples (all fields arithmetic) go through writePacked/readPacked. their
+// bytes have to be exactly the fields one after another, big endian, no varints
+
+#include <cstring>
+#include <tuple>
+#include <vector>
+
+#include "check.hpp"
+#include "util/BufferHelper.hpp"
+#include "util/varints.hpp"
+#include "util/net/Packet.hpp"
+
+using Rec = std::tuple<u16, i8, u32, float, bool, double, i64>;
+static constexpr sz_t recSize = 2 + 1 + 4 + 4 + 1 + 8 + 8;
+
+// what the generic path writes, field by field
+static sz_t writeFields(u8 * b, const Rec& r) {
+	u8 * p = b;
+	std::apply([&p] (auto... f) {
+		((p += buf::writeBE(p, f)), ...);
+	}, r);
+
+	return p - b;
+}
+
+static Rec mkRec(u32 i) {
+	return {static_cast<u16>(i * 7919), static_cast<i8>(-static_cast<i32>(i)), i * 2654435761u,
+		i * 0.37f - 5.f, (i & 1) != 0, -1.0 / (i + 1), -static_cast<i64>(i) << 33};
+}
+
+int main() {
+	using namespace pktdetail;
+
+	static_assert(is_tuple_arithmetic<Rec>::value && is_tuple_arithmetic<Rec>::size == recSize);
+	constexpr auto offs = packedOffsetsOf<Rec>;
+	static_assert(offs[0] == 0 && offs[1] == 2 && offs[2] == 3 && offs[3] == 7
+		&& offs[4] == 11 && offs[5] == 12 && offs[6] == 20);
+
+	u8 packed[recSize];
+	u8 fields[recSize];
+	for (u32 i = 0; i < 64; i++) {
+		Rec r = mkRec(i);
+		writePacked(packed, r);
+		CHECK(writeFields(fields, r) == recSize);
+		CHECK(std::memcmp(packed, fields, recSize) == 0);
+		CHECK(readPacked<Rec>(fields) == r);
+	}
+
+	// a vector of them: a varint count, then the records back to back
+	std::vector<Rec> recs;
+	for (u32 i = 0; i < 300; i++) {
+		recs.emplace_back(mkRec(i));
+	}
+
+	using Pkt = Packet<0, std::vector<Rec>, u8>;
+	std::vector<u8> msg;
+	Pkt::toBuffer(msg, recs, 9);
+
+	std::vector<u8> expected{0};
+	expected.resize(1 + unsignedVarintSize(recs.size()) + recs.size() * recSize + 1);
+	u8 * p = expected.data() + 1;
+	p += encodeUnsignedVarint(p, recs.size());
+	for (const Rec& r : recs) {
+		p += writeFields(p, r);
+	}
+
+	*p = 9;
+	CHECK(msg == expected);
+
+	auto dec = Pkt::tryFromBuffer(msg.data() + 1, msg.size() - 1);
+	CHECK(dec && std::get<0>(*dec) == recs && std::get<1>(*dec) == 9);
+	CHECK(Pkt::fromBuffer(msg.data() + 1, msg.size() - 1) == *dec);
+
+	// straight into per field arrays
+	std::vector<u16> firsts;
+	std::vector<i64> lasts;
+	readPackedArray<Rec>(msg.data() + 1 + unsignedVarintSize(recs.size()), recs.size(),
+		[&] (u16 a, i8, u32, float, bool, double, i64 g) {
+			firsts.emplace_back(a);
+			lasts.emplace_back(g);
+		});
+
+	CHECK(firsts.size() == recs.size());
+	for (sz_t i = 0; i < recs.size(); i++) {
+		CHECK(firsts[i] == std::get<0>(recs[i]) && lasts[i] == std::get<6>(recs[i]));
+	}
+
+	// cut anywhere, including in the middle of a record
+	for (sz_t n = 0; n + 1 < msg.size(); n += 7) {
+		CHECK(!Pkt::tryFromBuffer(msg.data() + 1, n));
+	}
+
+	// a lone tuple uses the same layout
+	using One = Packet<0, std::tuple<u16, u32>>;
+	One::toBuffer(msg, std::tuple<u16, u32>{0x0102, 0x03040506});
+	CHECK((msg == std::vector<u8>{0, 1, 2, 3, 4, 5, 6}));
+
+	return checkResult();
+}
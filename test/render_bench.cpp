@@ -0,0 +1,42 @@
+// the render bench's fixed path: frame checksums recorded in a browser are only comparable
+// while the camera path and generated chunks stay the same, so their checksum is pinned
+
+#include <cstdio>
+
+#include <GLES2/gl2.h>
+
+#include "check.hpp"
+#include "RenderBench.hpp"
+
+// frameEnded() reads the framebuffer, not called here
+void glReadPixels(GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, void *) { }
+
+int main() {
+	RenderBench rb(RenderBench::defaultConfig);
+	u32 scene = rb.sceneChecksum();
+	std::printf("default scene: %#X, reference %#X\n", scene, RenderBench::referenceScene);
+
+	// if the path or chunk generation changed on purpose, update referenceScene and
+	// record new golden frame checksums
+	CHECK(scene == RenderBench::referenceScene);
+	CHECK(rb.getResult().expectedScene == RenderBench::referenceScene);
+	CHECK(rb.getResult().scene == scene);
+
+	RenderBench::Config other = RenderBench::defaultConfig;
+	other.seed = 2;
+	RenderBench rb2(other);
+	CHECK(rb2.sceneChecksum() != scene);
+	CHECK(rb2.getResult().expectedScene == 0);
+
+	other = RenderBench::defaultConfig;
+	other.radius = 1.f;
+	CHECK(RenderBench(other).sceneChecksum() != scene);
+
+	// same chunk, same pixels
+	PngImage a(RenderBench::mkChunkImage(-3, 5, 7));
+	PngImage b(RenderBench::mkChunkImage(-3, 5, 7));
+	CHECK(a.getWidth() == ChunkConstants::size && a.getChannels() == 4);
+	CHECK(a.getPixel(10, 10).rgb == b.getPixel(10, 10).rgb);
+
+	return checkResult();
+}
@@ -0,0 +1,136 @@
+// StrokeApplier: which actions draw, how strokes join across batches and how pixels
+// reach the chunks
+
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+
+#include "check.hpp"
+#include "cursor_env.hpp"
+#include "world/CursorStore.hpp"
+#include "world/StrokeApplier.hpp"
+
+using Abs = std::vector<net::ToolAction<net::DAbsWPos>>;
+using Rel = std::vector<net::ToolAction<net::DRelWPos>>;
+
+struct Write {
+	Chunk::Pos cx;
+	Chunk::Pos cy;
+	std::vector<ChunkGlState::PxUpdate> px;
+};
+
+static const RGB_u red = {{255, 0, 0, 255}};
+static const RGB_u blue = {{0, 0, 255, 255}};
+
+static net::ToolAction<net::DAbsWPos> down(u32 pid, WorldPos x, WorldPos y, RGB_u clr = red) {
+	return {pid, x, y, net::TID_PENCIL, fakePencilState(true, clr)};
+}
+
+static net::ToolAction<net::DAbsWPos> up(u32 pid, WorldPos x, WorldPos y) {
+	return {pid, x, y, net::TID_PENCIL, fakePencilState(false, red)};
+}
+
+// the world positions written, in order
+static std::vector<std::pair<WorldPos, WorldPos>> written(const std::vector<Write>& ws) {
+	std::vector<std::pair<WorldPos, WorldPos>> out;
+	for (const Write& w : ws) {
+		for (const auto& p : w.px) {
+			out.emplace_back(w.cx * static_cast<WorldPos>(Chunk::size) + p.x, w.cy * static_cast<WorldPos>(Chunk::size) + p.y);
+		}
+	}
+
+	return out;
+}
+
+int main() {
+	constexpr u32 self = 1;
+	CursorStore cursors;
+	ToolManager& tm = fakeToolManager();
+	std::vector<Write> writes;
+	bool loaded = true;
+	StrokeApplier sa(cursors, tm, [&] (Chunk::Pos cx, Chunk::Pos cy, const ChunkGlState::PxUpdate * px, sz_t n) {
+		if (loaded) {
+			writes.push_back({cx, cy, {px, px + n}});
+		}
+
+		return loaded;
+	});
+
+	using P = std::pair<WorldPos, WorldPos>;
+
+	// a single click is one pixel, in our color
+	sa.apply({down(2, 10, 20, blue)}, {}, self);
+	CHECK(writes.size() == 1);
+	CHECK(written(writes) == (std::vector<P>{{10, 20}}));
+	CHECK(writes[0].px[0].rgba.rgb == blue.rgb);
+	CHECK(sa.getLastStats().actions == 1 && sa.getLastStats().pixels == 1 && sa.getLastStats().chunks == 1);
+
+	// the next batch continues the stroke with a line, without the point drawn already
+	writes.clear();
+	sa.apply({down(2, 13, 20)}, {}, self);
+	CHECK(written(writes) == (std::vector<P>{{11, 20}, {12, 20}, {13, 20}}));
+
+	// a batch without the player lifts the pencil
+	writes.clear();
+	sa.apply({}, {}, self);
+	sa.apply({down(2, 16, 20)}, {}, self);
+	CHECK(written(writes) == (std::vector<P>{{16, 20}}));
+
+	// so does a state that isn't clicking, or another tool
+	writes.clear();
+	sa.apply({up(2, 17, 20)}, {}, self);
+	CHECK(writes.empty());
+	sa.apply({down(2, 18, 20)}, {}, self);
+	sa.apply({{2, 19, 20, net::TID_MOVE, fakePencilState(true, red)}}, {}, self);
+	sa.apply({down(2, 20, 20)}, {}, self);
+	CHECK(written(writes) == (std::vector<P>{{18, 20}, {20, 20}}));
+
+	// long jumps start over instead of drawing a line
+	writes.clear();
+	sa.apply({down(2, 1000, 20)}, {}, self);
+	CHECK(written(writes) == (std::vector<P>{{1000, 20}}));
+
+	// several actions in a batch join up too
+	writes.clear();
+	sa.apply({down(3, 0, 0), down(3, 0, 2), down(3, 2, 2)}, {}, self);
+	CHECK(written(writes) == (std::vector<P>{{0, 0}, {0, 1}, {0, 2}, {1, 2}, {2, 2}}));
+
+	// our own actions were drawn locally
+	writes.clear();
+	sa.apply({down(self, 5, 5)}, {}, self);
+	CHECK(writes.empty());
+
+	// relative actions need the player's cursor
+	writes.clear();
+	sa.apply({}, {{4, 1, 1, net::TID_PENCIL, fakePencilState(true, red)}}, self);
+	CHECK(writes.empty());
+	cursors.insert(fakeUser(), 4, 100, 200, 0, tm, net::TID_PENCIL, 0);
+	sa.apply({}, {{4, 1, -1, net::TID_PENCIL, fakePencilState(true, red)}}, self);
+	CHECK(written(writes) == (std::vector<P>{{101, 199}}));
+	cursors.insert(fakeUser(), self, 0, 0, 0, tm, net::TID_PENCIL, 0);
+	writes.clear();
+	sa.apply({}, {{self, 1, 1, net::TID_PENCIL, fakePencilState(true, red)}}, self);
+	CHECK(writes.empty());
+
+	// one write per chunk, strokes crossing chunks are split, and in a chunk the
+	// pixels keep the order they were received in
+	writes.clear();
+	const WorldPos edge = Chunk::size;
+	sa.apply({down(5, edge - 2, 0), down(6, edge + 1, 5), down(5, edge + 1, 0), down(6, edge - 1, 5, blue)}, {}, self);
+	CHECK(writes.size() == 2);
+	CHECK(sa.getLastStats().chunks == 2);
+	std::sort(writes.begin(), writes.end(), [] (const Write& a, const Write& b) {
+		return a.cx < b.cx;
+	});
+
+	CHECK(written({writes[0]}) == (std::vector<P>{{edge - 2, 0}, {edge - 1, 0}, {edge - 1, 5}}));
+	CHECK(written({writes[1]}) == (std::vector<P>{{edge + 1, 5}, {edge, 0}, {edge + 1, 0}, {edge, 5}}));
+	CHECK(writes[0].px.back().rgba.rgb == blue.rgb);
+
+	// pixels on chunks we don't have are dropped
+	loaded = false;
+	sa.apply({down(7, -5000, -5000)}, {}, self);
+	CHECK(sa.getLastStats().pixels == 1 && sa.getLastStats().chunks == 0);
+
+	return checkResult();
+}